@@ -0,0 +1,197 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "CIEDE.h"
+
+static constexpr double pi{ 3.14159265358979323846 };
+
+// The sRGB and CIELAB transfer functions, computed exactly rather than from tables.
+static float srgbToLinear(float c) noexcept {
+    return c > 0.04045f ? std::pow((c + 0.055f) / 1.055f, 2.4f) : c / 12.92f;
+}
+
+static float labCurve(float t) noexcept {
+    constexpr float delta{ 6.0f / 29.0f };
+    return t > delta * delta * delta ? std::cbrt(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+}
+
+CIEDE2000::CIEDE2000(int bits) : bitsPerSample{ bits } {
+    auto codes{ 1u << bits };
+    auto scale{ 1.0 / (1 << (bits - 8)) };
+
+    for (unsigned c{ 0 }; c < codes; c++) {
+        auto y{ (c * scale - 16.0) / 219.0 };
+        auto chroma{ (c * scale - 128.0) / 224.0 };
+
+        luma.push_back(static_cast<float>(y));
+        blueFromU.push_back(static_cast<float>(1.8556 * chroma));
+        greenFromU.push_back(static_cast<float>(-0.187324 * chroma));
+        redFromV.push_back(static_cast<float>(1.5748 * chroma));
+        greenFromV.push_back(static_cast<float>(-0.468124 * chroma));
+    }
+}
+
+template<typename T>
+void CIEDE2000::toLab(const T* y, const T* u, const T* v, unsigned width, int ssW, float* l, float* a, float* b) const noexcept {
+    auto mask{ static_cast<unsigned>((1 << bitsPerSample) - 1) };
+
+    for (unsigned x{ 0 }; x < width; x++) {
+        auto cu{ u[x >> ssW] & mask };
+        auto cv{ v[x >> ssW] & mask };
+        auto luminance{ luma[y[x] & mask] };
+
+        auto red{ srgbToLinear(luminance + redFromV[cv]) };
+        auto green{ srgbToLinear(luminance + greenFromU[cu] + greenFromV[cv]) };
+        auto blue{ srgbToLinear(luminance + blueFromU[cu]) };
+
+        // sRGB to XYZ, divided by the D65 white point.
+        auto fx{ labCurve((0.4124564f * red + 0.3575761f * green + 0.1804375f * blue) / 0.95047f) };
+        auto fy{ labCurve(0.2126729f * red + 0.7151522f * green + 0.0721750f * blue) };
+        auto fz{ labCurve((0.0193339f * red + 0.1191920f * green + 0.9503041f * blue) / 1.08883f) };
+
+        l[x] = 116.0f * fy - 16.0f;
+        a[x] = 500.0f * (fx - fy);
+        b[x] = 200.0f * (fy - fz);
+    }
+}
+
+// CIEDE2000 after Sharma, Wu and Dalal, with the weights libvmaf uses.
+static float deltaE(float l1, float a1, float b1, float l2, float a2, float b2) noexcept {
+    constexpr float kL{ 0.65f };
+    constexpr float kC{ 1.0f };
+    constexpr float kH{ 4.0f };
+    constexpr float pow25to7{ 6103515625.0f };
+    constexpr auto degrees{ static_cast<float>(180.0 / pi) };
+    constexpr auto radians{ static_cast<float>(pi / 180.0) };
+
+    auto c1{ std::sqrt(a1 * a1 + b1 * b1) };
+    auto c2{ std::sqrt(a2 * a2 + b2 * b2) };
+    auto cMean7{ std::pow((c1 + c2) / 2.0f, 7.0f) };
+    auto g{ 0.5f * (1.0f - std::sqrt(cMean7 / (cMean7 + pow25to7))) };
+
+    auto a1p{ (1.0f + g) * a1 };
+    auto a2p{ (1.0f + g) * a2 };
+    auto c1p{ std::sqrt(a1p * a1p + b1 * b1) };
+    auto c2p{ std::sqrt(a2p * a2p + b2 * b2) };
+
+    auto hue = [&](float b, float ap) {
+        if (b == 0.0f && ap == 0.0f)
+            return 0.0f;
+        auto h{ std::atan2(b, ap) * degrees };
+        return h < 0.0f ? h + 360.0f : h;
+    };
+
+    auto h1p{ hue(b1, a1p) };
+    auto h2p{ hue(b2, a2p) };
+
+    auto dLp{ l2 - l1 };
+    auto dCp{ c2p - c1p };
+    auto dhp{ 0.0f };
+
+    if (c1p * c2p != 0.0f) {
+        dhp = h2p - h1p;
+        if (dhp > 180.0f)
+            dhp -= 360.0f;
+        else if (dhp < -180.0f)
+            dhp += 360.0f;
+    }
+
+    auto dHp{ 2.0f * std::sqrt(c1p * c2p) * std::sin(dhp * radians / 2.0f) };
+
+    auto lMean{ (l1 + l2) / 2.0f };
+    auto cMeanP{ (c1p + c2p) / 2.0f };
+    auto hMeanP{ h1p + h2p };
+
+    if (c1p * c2p != 0.0f) {
+        if (std::abs(h1p - h2p) <= 180.0f)
+            hMeanP /= 2.0f;
+        else
+            hMeanP = hMeanP < 360.0f ? (hMeanP + 360.0f) / 2.0f : (hMeanP - 360.0f) / 2.0f;
+    }
+
+    auto t{ 1.0f - 0.17f * std::cos((hMeanP - 30.0f) * radians) + 0.24f * std::cos(2.0f * hMeanP * radians) +
+            0.32f * std::cos((3.0f * hMeanP + 6.0f) * radians) - 0.20f * std::cos((4.0f * hMeanP - 63.0f) * radians) };
+    auto dTheta{ 30.0f * std::exp(-((hMeanP - 275.0f) / 25.0f) * ((hMeanP - 275.0f) / 25.0f)) };
+    auto cMeanP7{ std::pow(cMeanP, 7.0f) };
+    auto rC{ 2.0f * std::sqrt(cMeanP7 / (cMeanP7 + pow25to7)) };
+    auto lMean50{ (lMean - 50.0f) * (lMean - 50.0f) };
+    auto sL{ 1.0f + 0.015f * lMean50 / std::sqrt(20.0f + lMean50) };
+    auto sC{ 1.0f + 0.045f * cMeanP };
+    auto sH{ 1.0f + 0.015f * cMeanP * t };
+    auto rT{ -std::sin(2.0f * dTheta * radians) * rC };
+
+    auto l{ dLp / (kL * sL) };
+    auto c{ dCp / (kC * sC) };
+    auto h{ dHp / (kH * sH) };
+
+    return std::sqrt(l * l + c * c + h * h + rT * c * h);
+}
+
+double CIEDE2000::score(const void* const reference[3], const ptrdiff_t referenceStride[3], const void* const distorted[3],
+                        const ptrdiff_t distortedStride[3], unsigned width, unsigned height, int ssW, int ssH) const {
+    thread_local std::vector<float> lab;
+    lab.resize(static_cast<size_t>(width) * 6);
+
+    auto l1{ lab.data() };
+    auto a1{ l1 + width };
+    auto b1{ a1 + width };
+    auto l2{ b1 + width };
+    auto a2{ l2 + width };
+    auto b2{ a2 + width };
+
+    auto row = [](const void* plane, ptrdiff_t stride, unsigned y) {
+        return static_cast<const uint8_t*>(plane) + y * stride;
+    };
+
+    double total{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        // Converted a row at a time into separate planes of L, a and b, so that the difference runs along contiguous samples.
+        if (bitsPerSample > 8) {
+            toLab(reinterpret_cast<const uint16_t*>(row(reference[0], referenceStride[0], y)),
+                  reinterpret_cast<const uint16_t*>(row(reference[1], referenceStride[1], y >> ssH)),
+                  reinterpret_cast<const uint16_t*>(row(reference[2], referenceStride[2], y >> ssH)), width, ssW, l1, a1, b1);
+            toLab(reinterpret_cast<const uint16_t*>(row(distorted[0], distortedStride[0], y)),
+                  reinterpret_cast<const uint16_t*>(row(distorted[1], distortedStride[1], y >> ssH)),
+                  reinterpret_cast<const uint16_t*>(row(distorted[2], distortedStride[2], y >> ssH)), width, ssW, l2, a2, b2);
+        } else {
+            toLab(row(reference[0], referenceStride[0], y), row(reference[1], referenceStride[1], y >> ssH),
+                  row(reference[2], referenceStride[2], y >> ssH), width, ssW, l1, a1, b1);
+            toLab(row(distorted[0], distortedStride[0], y), row(distorted[1], distortedStride[1], y >> ssH),
+                  row(distorted[2], distortedStride[2], y >> ssH), width, ssW, l2, a2, b2);
+        }
+
+        auto sum{ 0.0f };
+        for (unsigned x{ 0 }; x < width; x++)
+            sum += deltaE(l1[x], a1[x], b1[x], l2[x], a2[x], b2[x]);
+
+        total += sum;
+    }
+
+    return 45.0 - 20.0 * std::log10(total / (static_cast<double>(width) * height));
+}
@@ -0,0 +1,51 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// CIEDE2000 colour difference of a YUV frame against the reference's, like libvmaf's ciede2000: BT.709 limited-range YUV to sRGB
+// with chroma upsampled by repetition, then D65 CIELAB, and the mean difference reported as 45 - 20 log10(mean). The conversion
+// to RGB is table driven per bit depth, while the sRGB and CIELAB transfer functions are computed exactly.
+class CIEDE2000 final {
+    int bitsPerSample;
+    std::vector<float> luma;
+    std::vector<float> blueFromU;
+    std::vector<float> greenFromU;
+    std::vector<float> redFromV;
+    std::vector<float> greenFromV;
+
+    template<typename T>
+    void toLab(const T* y, const T* u, const T* v, unsigned width, int ssW, float* l, float* a, float* b) const noexcept;
+
+public:
+    explicit CIEDE2000(int bits);
+
+    // Planes are given as their top-left sample and stride in bytes, samples are 8-bit or 16-bit words holding bitsPerSample
+    // significant bits. Width and height are the luma's.
+    double score(const void* const reference[3], const ptrdiff_t referenceStride[3], const void* const distorted[3],
+                 const ptrdiff_t distortedStride[3], unsigned width, unsigned height, int ssW, int ssH) const;
+};
@@ -0,0 +1,98 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Crop.h"
+
+ActiveArea::ActiveArea(unsigned planeWidth, unsigned planeHeight, int bitsPerSample)
+    : width{ planeWidth }, height{ planeHeight }, activeRow(planeHeight), activeColumn(planeWidth), columnSum(planeWidth),
+      columnSquares(planeWidth) {
+    auto scale{ static_cast<double>(1 << (bitsPerSample - 8)) };
+
+    // Limited-range black is 16, bars are rarely far above it and their noise stays within a few codes.
+    blackLevel = 32.0 * scale;
+    flatness = 3.0 * scale * 3.0 * scale;
+}
+
+template<typename T>
+void ActiveArea::add(const T* luma, ptrdiff_t stride) {
+    stride /= sizeof(T);
+
+    std::vector<bool> rows(height);
+    std::fill(columnSum.begin(), columnSum.end(), 0);
+    std::fill(columnSquares.begin(), columnSquares.end(), 0);
+
+    auto active = [&](uint64_t sum, uint64_t squares, unsigned count) {
+        auto mean{ static_cast<double>(sum) / count };
+        return mean > blackLevel || static_cast<double>(squares) / count - mean * mean > flatness;
+    };
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        auto srcp{ luma + y * stride };
+        uint64_t sum{};
+        uint64_t squares{};
+
+        for (unsigned x{ 0 }; x < width; x++) {
+            uint64_t value{ srcp[x] };
+            sum += value;
+            squares += value * value;
+            columnSum[x] += value;
+            columnSquares[x] += value * value;
+        }
+
+        rows[y] = active(sum, squares, width);
+    }
+
+    if (std::find(rows.cbegin(), rows.cend(), true) == rows.cend())
+        return;
+
+    for (unsigned y{ 0 }; y < height; y++)
+        activeRow[y] = activeRow[y] || rows[y];
+
+    for (unsigned x{ 0 }; x < width; x++)
+        activeColumn[x] = activeColumn[x] || active(columnSum[x], columnSquares[x], height);
+}
+
+void ActiveArea::add(const void* luma, ptrdiff_t stride, int bitsPerSample) {
+    if (bitsPerSample > 8)
+        add(static_cast<const uint16_t*>(luma), stride);
+    else
+        add(static_cast<const uint8_t*>(luma), stride);
+}
+
+bool ActiveArea::bounds(int* left, int* right, int* top, int* bottom) const noexcept {
+    auto firstRow{ std::find(activeRow.cbegin(), activeRow.cend(), true) };
+    auto firstColumn{ std::find(activeColumn.cbegin(), activeColumn.cend(), true) };
+
+    if (firstRow == activeRow.cend() || firstColumn == activeColumn.cend())
+        return false;
+
+    *top = static_cast<int>(firstRow - activeRow.cbegin());
+    *bottom = static_cast<int>(std::find(activeRow.crbegin(), activeRow.crend(), true) - activeRow.crbegin());
+    *left = static_cast<int>(firstColumn - activeColumn.cbegin());
+    *right = static_cast<int>(std::find(activeColumn.crbegin(), activeColumn.crend(), true) - activeColumn.crbegin());
+    return true;
+}
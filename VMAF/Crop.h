@@ -0,0 +1,55 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Finds the active picture area of a clip from the luma of a few frames. A row or column is inactive when it is flat and dark in
+// every frame, which is what letterboxing, pillarboxing and black codec padding look like. Frames that are dark and flat all
+// over, like fades, say nothing about the bars and are ignored.
+class ActiveArea final {
+    unsigned width;
+    unsigned height;
+    double blackLevel;
+    double flatness;
+    std::vector<bool> activeRow;
+    std::vector<bool> activeColumn;
+    std::vector<uint64_t> columnSum;
+    std::vector<uint64_t> columnSquares;
+
+    template<typename T>
+    void add(const T* luma, ptrdiff_t stride);
+
+public:
+    ActiveArea(unsigned planeWidth, unsigned planeHeight, int bitsPerSample);
+
+    // The stride is in bytes, samples are 8-bit or 16-bit words holding bitsPerSample significant bits.
+    void add(const void* luma, ptrdiff_t stride, int bitsPerSample);
+
+    // Number of rows and columns to crop on each side, or false when no frame had any active area.
+    bool bounds(int* left, int* right, int* top, int* bottom) const noexcept;
+};
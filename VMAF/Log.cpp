@@ -0,0 +1,660 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "Log.h"
+#include "ScoreLog.h"
+
+static constexpr const char* poolMethodName[]{ "none", "min", "max", "mean", "harmonic_mean" };
+
+// Rows are written out once a segment has buffered this much.
+static constexpr size_t batchSize{ 1 << 20 };
+
+void PooledScore::add(double score) noexcept {
+    min = std::min(min, score);
+    max = std::max(max, score);
+    sum += score;
+    harmonicSum += 1.0 / (score + 1.0);
+    count++;
+}
+
+void PooledScore::merge(const PooledScore& other) noexcept {
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+    harmonicSum += other.harmonicSum;
+    count += other.count;
+}
+
+bool PooledScore::pooled(VmafPoolingMethod method, double* score) const noexcept {
+    if (!count)
+        return false;
+
+    switch (method) {
+    case VMAF_POOL_METHOD_MIN:
+        *score = min;
+        return true;
+    case VMAF_POOL_METHOD_MAX:
+        *score = max;
+        return true;
+    case VMAF_POOL_METHOD_MEAN:
+        *score = sum / count;
+        return true;
+    case VMAF_POOL_METHOD_HARMONIC_MEAN:
+        *score = count / harmonicSum - 1.0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void appendf(std::string& buffer, const char* format, ...) {
+    char stack[512];
+
+    va_list args;
+    va_start(args, format);
+    auto length{ vsnprintf(stack, sizeof(stack), format, args) };
+    va_end(args);
+
+    if (length < 0)
+        return;
+
+    if (static_cast<size_t>(length) < sizeof(stack)) {
+        buffer.append(stack, length);
+        return;
+    }
+
+    auto offset{ buffer.size() };
+    buffer.resize(offset + length + 1);
+
+    va_start(args, format);
+    vsnprintf(buffer.data() + offset, length + 1, format, args);
+    va_end(args);
+
+    buffer.resize(offset + length);
+}
+
+static bool seek(FILE* file, uint64_t offset) noexcept {
+#ifdef _WIN32
+    return !_fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+    return !fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+LogWriter::LogWriter(const std::string& logPath, VmafOutputFormat logFormat, unsigned logWidth, unsigned logHeight,
+                     unsigned frames) noexcept
+    : path{ logPath }, format{ logFormat }, width{ logWidth }, height{ logHeight }, numFrames{ frames } {}
+
+LogWriter::~LogWriter() {
+    for (auto&& segment : segments) {
+        segment.file.reset();
+        if (!segment.path.empty() && segment.path != path)
+            std::remove(segment.path.c_str());
+    }
+}
+
+bool LogWriter::open(size_t numSegments) {
+    segments.resize(numSegments);
+
+    if (format == outputFormatBinary) {
+        binary.reset(fopen(path.c_str(), "w+b"));
+        return !!binary;
+    }
+
+    for (size_t i{ 0 }; i < numSegments; i++) {
+        auto direct{ !i && (format == VMAF_OUTPUT_FORMAT_CSV || format == VMAF_OUTPUT_FORMAT_SUB) };
+
+        segments[i].path = direct ? path : path + "." + std::to_string(i) + ".part";
+        segments[i].file.reset(fopen(segments[i].path.c_str(), direct ? "w" : "w+b"));
+
+        if (!segments[i].file)
+            return false;
+    }
+
+    return true;
+}
+
+void LogWriter::setColumns(std::vector<std::string> aliases) {
+    columns = std::move(aliases);
+
+    // Columnar logs flag interpolated frames in a column of their own, whose mean is the fraction that was interpolated.
+    if (interpolation && (format == VMAF_OUTPUT_FORMAT_CSV || format == outputFormatBinary)) {
+        columns.push_back("interpolated");
+        flagColumn = true;
+    }
+
+    pool.resize(columns.size());
+    hasColumns = true;
+
+    if (format == VMAF_OUTPUT_FORMAT_CSV) {
+        auto& segment{ segments.front() };
+
+        segment.buffer += "Frame,";
+        for (auto&& column : columns)
+            appendf(segment.buffer, "%s,", column.c_str());
+        segment.buffer += "\n";
+    }
+
+    if (format == outputFormatBinary && binary) {
+        auto headerSize{ sizeof(VmafScoreLogHeader) + columns.size() * sizeof(VmafScoreLogColumn) };
+        dataOffset = (headerSize + VMAF_SCORE_LOG_ALIGNMENT - 1) / VMAF_SCORE_LOG_ALIGNMENT * VMAF_SCORE_LOG_ALIGNMENT;
+
+        writeBinaryHeader(std::numeric_limits<double>::quiet_NaN(),
+                          dataOffset + columns.size() * numFrames * sizeof(double), 0, 0);
+
+        // Frames that never get a score read as NaN, so every column is filled up front and rows only overwrite what they have.
+        std::vector<double> fill(batchSize / sizeof(double), std::numeric_limits<double>::quiet_NaN());
+        auto remaining{ static_cast<uint64_t>(columns.size()) * numFrames };
+
+        seek(binary.get(), dataOffset);
+        while (remaining) {
+            auto count{ static_cast<size_t>(std::min<uint64_t>(remaining, fill.size())) };
+            fwrite(fill.data(), sizeof(double), count, binary.get());
+            remaining -= count;
+        }
+    }
+}
+
+bool LogWriter::writeBinaryHeader(double fps, uint64_t aggregateOffset, uint32_t numAggregates, uint64_t sectionOffset) {
+    VmafScoreLogHeader header{};
+    memcpy(header.magic, VMAF_SCORE_LOG_MAGIC, sizeof(header.magic));
+    header.version = VMAF_SCORE_LOG_VERSION;
+    header.numColumns = static_cast<uint32_t>(columns.size());
+    header.numFrames = numFrames;
+    header.dataOffset = dataOffset;
+    header.aggregateOffset = aggregateOffset;
+    header.numAggregates = numAggregates;
+    header.width = width;
+    header.height = height;
+    header.cropLeft = crop[0];
+    header.cropRight = crop[1];
+    header.cropTop = crop[2];
+    header.cropBottom = crop[3];
+    header.flags = (cropDetected ? VMAF_SCORE_LOG_CROP_DETECTED : 0) | (preview ? VMAF_SCORE_LOG_PREVIEW : 0);
+    header.firstFrame = firstFrame;
+    header.numSegments = static_cast<uint32_t>(sections.size());
+    header.fps = fps;
+    header.segmentOffset = sectionOffset;
+
+    std::vector<VmafScoreLogColumn> descriptor(columns.size());
+
+    for (size_t i{ 0 }; i < columns.size(); i++) {
+        strncpy(descriptor[i].name, columns[i].c_str(), sizeof(descriptor[i].name) - 1);
+
+        for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++)
+            if (!pooled(i, static_cast<VmafPoolingMethod>(method), &descriptor[i].pooled[method - 1]))
+                descriptor[i].pooled[method - 1] = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return seek(binary.get(), 0) &&
+        fwrite(&header, sizeof(header), 1, binary.get()) == 1 &&
+        fwrite(descriptor.data(), sizeof(VmafScoreLogColumn), descriptor.size(), binary.get()) == descriptor.size();
+}
+
+// Scatters a run of consecutive rows into the columns, one contiguous write per column.
+bool LogWriter::flushRun(Segment& segment) {
+    if (!segment.runLength)
+        return true;
+
+    std::vector<double> column(segment.runLength);
+    auto success{ true };
+
+    for (size_t i{ 0 }; i < columns.size(); i++) {
+        for (unsigned row{ 0 }; row < segment.runLength; row++)
+            column[row] = segment.run[row * columns.size() + i];
+
+        success &= seek(binary.get(), dataOffset + (i * numFrames + segment.runStart) * sizeof(double)) &&
+            fwrite(column.data(), sizeof(double), column.size(), binary.get()) == column.size();
+    }
+
+    segment.run.clear();
+    segment.runLength = 0;
+    return success;
+}
+
+void LogWriter::flush(Segment& segment) {
+    if (!segment.buffer.empty() && segment.file)
+        fwrite(segment.buffer.data(), 1, segment.buffer.size(), segment.file.get());
+    segment.buffer.clear();
+}
+
+void LogWriter::append(size_t index, unsigned frame, unsigned piece, const std::vector<double>& score,
+                       const std::vector<bool>& written, bool interpolated) {
+    if (!flagColumn) {
+        appendRow(index, frame, piece, score, written, interpolated);
+        return;
+    }
+
+    rowScore.assign(score.cbegin(), score.cend());
+    rowScore.push_back(interpolated ? 1.0 : 0.0);
+    rowWritten.assign(written.cbegin(), written.cend());
+    rowWritten.push_back(true);
+
+    appendRow(index, frame, piece, rowScore, rowWritten, interpolated);
+}
+
+void LogWriter::appendRow(size_t index, unsigned frame, unsigned piece, const std::vector<double>& score,
+                          const std::vector<bool>& written, bool interpolated) {
+    auto count{ std::count(written.cbegin(), written.cend(), true) };
+    if (!count)
+        return;
+
+    for (size_t i{ 0 }; i < columns.size(); i++)
+        if (written[i])
+            pool[i].add(score[i]);
+
+    if (sectioned) {
+        auto& pieceScore{ pieces[piece] };
+        pieceScore.resize(columns.size());
+
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            if (written[i])
+                pieceScore[i].add(score[i]);
+    }
+
+    if (format == outputFormatBinary) {
+        auto& segment{ segments[index] };
+
+        if (segment.runLength && frame != segment.runStart + segment.runLength)
+            flushRun(segment);
+        if (!segment.runLength)
+            segment.runStart = frame;
+
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            segment.run.push_back(written[i] ? score[i] : std::numeric_limits<double>::quiet_NaN());
+        segment.runLength++;
+
+        if (segment.run.size() * sizeof(double) >= batchSize)
+            flushRun(segment);
+        return;
+    }
+
+    auto& buffer{ segments[index].buffer };
+    segments[index].rows++;
+
+    switch (format) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        appendf(buffer, "    <frame frameNum=\"%u\" ", firstFrame + frame);
+        if (interpolated)
+            buffer += "interpolated=\"1\" ";
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            if (written[i])
+                appendf(buffer, "%s=\"%.6f\" ", columns[i].c_str(), score[i]);
+        buffer += "/>\n";
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        // Whether an earlier segment has rows is only known once they are assembled, so every row starts with a separator and
+        // close() leaves out the first one.
+        buffer += ",\n";
+        buffer += "    {\n";
+        appendf(buffer, "      \"frameNum\": %u,\n", firstFrame + frame);
+        if (interpolated)
+            buffer += "      \"interpolated\": true,\n";
+        buffer += "      \"metrics\": {\n";
+
+        for (size_t i{ 0 }; i < columns.size(); i++) {
+            if (!written[i])
+                continue;
+
+            appendf(buffer, "        \"%s\": ", columns[i].c_str());
+            appendf(buffer, "%.6f", score[i]);
+            buffer += --count ? ",\n" : "\n";
+        }
+
+        buffer += "      }\n";
+        buffer += "    }";
+        break;
+    case VMAF_OUTPUT_FORMAT_CSV:
+        appendf(buffer, "%u,", firstFrame + frame);
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            if (written[i])
+                appendf(buffer, "%.6f,", score[i]);
+        buffer += "\n";
+        break;
+    case VMAF_OUTPUT_FORMAT_SUB:
+        appendf(buffer, "{%u}{%u}", firstFrame + frame, firstFrame + frame + 1);
+        if (interpolated)
+            buffer += "interpolated|";
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            if (written[i])
+                appendf(buffer, "%s: %.6f|", columns[i].c_str(), score[i]);
+        buffer += "\n";
+        break;
+    default:
+        break;
+    }
+
+    if (buffer.size() >= batchSize)
+        flush(segments[index]);
+}
+
+bool LogWriter::copyInto(FILE* dst, Segment& segment, long skip) {
+    flush(segment);
+
+    if (!segment.file || fflush(segment.file.get()) || fseek(segment.file.get(), skip, SEEK_SET))
+        return false;
+
+    std::unique_ptr<char[]> chunk{ new char[batchSize] };
+
+    while (auto size{ fread(chunk.get(), 1, batchSize, segment.file.get()) })
+        if (fwrite(chunk.get(), 1, size, dst) != size)
+            return false;
+
+    return !ferror(segment.file.get());
+}
+
+bool LogWriter::closeBinary(double fps, const std::vector<std::pair<std::string, double>>& aggregate) {
+    auto success{ true };
+    for (auto&& segment : segments)
+        success &= flushRun(segment);
+
+    auto aggregateOffset{ dataOffset + static_cast<uint64_t>(columns.size()) * numFrames * sizeof(double) };
+    std::vector<VmafScoreLogAggregate> trailer(aggregate.size());
+
+    for (size_t i{ 0 }; i < aggregate.size(); i++) {
+        strncpy(trailer[i].name, aggregate[i].first.c_str(), sizeof(trailer[i].name) - 1);
+        trailer[i].value = aggregate[i].second;
+    }
+
+    success &= seek(binary.get(), aggregateOffset) &&
+        fwrite(trailer.data(), sizeof(VmafScoreLogAggregate), trailer.size(), binary.get()) == trailer.size();
+
+    uint64_t sectionOffset{};
+
+    if (!sections.empty()) {
+        sectionOffset = aggregateOffset + trailer.size() * sizeof(VmafScoreLogAggregate);
+
+        std::vector<VmafScoreLogSegment> bounds;
+        std::vector<double> sectionPooled;
+
+        for (auto&& section : sections) {
+            bounds.push_back({ firstFrame + section.first, firstFrame + section.last });
+
+            for (size_t i{ 0 }; i < columns.size(); i++) {
+                for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++) {
+                    double score;
+                    auto found{ pooled(section, i, static_cast<VmafPoolingMethod>(method), &score) };
+                    sectionPooled.push_back(found ? score : std::numeric_limits<double>::quiet_NaN());
+                }
+            }
+        }
+
+        success &= fwrite(bounds.data(), sizeof(VmafScoreLogSegment), bounds.size(), binary.get()) == bounds.size() &&
+            fwrite(sectionPooled.data(), sizeof(double), sectionPooled.size(), binary.get()) == sectionPooled.size();
+    }
+
+    success &= writeBinaryHeader(fps, aggregateOffset, static_cast<uint32_t>(trailer.size()), sectionOffset);
+
+    return success && !ferror(binary.get()) && !fflush(binary.get());
+}
+
+void LogWriter::buildSections(const std::vector<unsigned>& starts) {
+    for (size_t i{ 0 }; i < starts.size(); i++)
+        sections.push_back({ starts[i], i + 1 < starts.size() ? starts[i + 1] - 1 : numFrames - 1,
+                             std::vector<PooledScore>(columns.size()) });
+
+    // Every piece starts within exactly one section and never crosses into the next, as sections start new pieces.
+    auto section{ sections.begin() };
+
+    for (auto&& [start, pieceScore] : pieces) {
+        while (section + 1 != sections.end() && (section + 1)->first <= start)
+            section++;
+
+        for (size_t i{ 0 }; i < columns.size(); i++)
+            section->pool[i].merge(pieceScore[i]);
+    }
+}
+
+// CSV and subtitle logs have nowhere to put a table after the frames, so the sections go to a CSV file next to the log.
+bool LogWriter::writeSectionTable() const {
+    std::unique_ptr<FILE, decltype(&fclose)> file{ fopen((path + ".segments.csv").c_str(), "w"), fclose };
+    if (!file)
+        return false;
+
+    std::string buffer{ "First,Last," };
+
+    for (auto&& column : columns)
+        for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++)
+            appendf(buffer, "%s_%s,", column.c_str(), poolMethodName[method]);
+    buffer += "\n";
+
+    for (auto&& section : sections) {
+        appendf(buffer, "%u,%u,", firstFrame + section.first, firstFrame + section.last);
+
+        for (size_t i{ 0 }; i < columns.size(); i++) {
+            for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++) {
+                if (double score; pooled(section, i, static_cast<VmafPoolingMethod>(method), &score))
+                    appendf(buffer, "%.6f", score);
+                buffer += ",";
+            }
+        }
+
+        buffer += "\n";
+    }
+
+    return fwrite(buffer.data(), 1, buffer.size(), file.get()) == buffer.size() && !fflush(file.get());
+}
+
+bool LogWriter::close(double fps, const std::vector<std::pair<std::string, double>>& aggregate,
+                      const std::vector<unsigned>& sectionStarts) {
+    if (segments.empty())
+        return false;
+
+    if (!hasColumns)
+        setColumns({});
+
+    if (sectioned)
+        buildSections(sectionStarts);
+
+    if ((format == VMAF_OUTPUT_FORMAT_CSV || format == VMAF_OUTPUT_FORMAT_SUB) && !sections.empty() && !writeSectionTable())
+        return false;
+
+    if (format == outputFormatBinary)
+        return binary && closeBinary(fps, aggregate);
+
+    std::unique_ptr<FILE, decltype(&fclose)> owned{ nullptr, fclose };
+    FILE* file;
+
+    if (segments.front().path == path) {
+        flush(segments.front());
+        file = segments.front().file.get();
+    } else {
+        owned.reset(fopen(path.c_str(), "w"));
+        file = owned.get();
+    }
+
+    if (!file)
+        return false;
+
+    std::string buffer;
+
+    switch (format) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        appendf(buffer, "<VMAF version=\"%s\">\n", vmaf_version());
+        appendf(buffer, "  <params qualityWidth=\"%u\" qualityHeight=\"%u\" />\n", width, height);
+        if (firstFrame)
+            appendf(buffer, "  <range first=\"%u\" last=\"%u\" />\n", firstFrame, firstFrame + numFrames - 1);
+        if (cropped())
+            appendf(buffer, "  <crop left=\"%d\" right=\"%d\" top=\"%d\" bottom=\"%d\" detected=\"%d\" />\n", crop[0], crop[1],
+                    crop[2], crop[3], cropDetected);
+        if (preview)
+            buffer += "  <preview downscale=\"2\" />\n";
+        appendf(buffer, "  <fyi fps=\"%.2f\" />\n", fps);
+        buffer += "  <frames>\n";
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        buffer += "{\n";
+        appendf(buffer, "  \"version\": \"%s\",\n", vmaf_version());
+        if (firstFrame)
+            appendf(buffer, "  \"range\": { \"first\": %u, \"last\": %u },\n", firstFrame, firstFrame + numFrames - 1);
+        if (cropped())
+            appendf(buffer, "  \"crop\": { \"left\": %d, \"right\": %d, \"top\": %d, \"bottom\": %d, \"detected\": %s },\n",
+                    crop[0], crop[1], crop[2], crop[3], cropDetected ? "true" : "false");
+        if (preview)
+            buffer += "  \"preview\": { \"downscale\": 2 },\n";
+        appendf(buffer, "  \"fps\": %.2f,\n", fps);
+        buffer += "  \"frames\": [";
+        break;
+    default:
+        break;
+    }
+
+    fwrite(buffer.data(), 1, buffer.size(), file);
+
+    auto leading{ format == VMAF_OUTPUT_FORMAT_JSON };
+
+    for (auto&& segment : segments) {
+        if (segment.path != path && !copyInto(file, segment, leading && segment.rows ? 1 : 0))
+            return false;
+        leading &= !segment.rows;
+    }
+
+    buffer.clear();
+
+    switch (format) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        buffer += "  </frames>\n";
+        buffer += "  <pooled_metrics>\n";
+
+        for (size_t i{ 0 }; i < columns.size(); i++) {
+            appendf(buffer, "    <metric name=\"%s\" ", columns[i].c_str());
+            for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++)
+                if (double score; pooled(i, static_cast<VmafPoolingMethod>(method), &score))
+                    appendf(buffer, "%s=\"%.6f\" ", poolMethodName[method], score);
+            buffer += "/>\n";
+        }
+
+        buffer += "  </pooled_metrics>\n";
+        buffer += "  <aggregate_metrics ";
+        for (auto&& [name, value] : aggregate)
+            appendf(buffer, "%s=\"%.6f\" ", name.c_str(), value);
+        buffer += "/>\n";
+
+        if (!sections.empty()) {
+            buffer += "  <segments>\n";
+
+            for (auto&& section : sections) {
+                appendf(buffer, "    <segment first=\"%u\" last=\"%u\">\n", firstFrame + section.first,
+                        firstFrame + section.last);
+
+                for (size_t i{ 0 }; i < columns.size(); i++) {
+                    appendf(buffer, "      <metric name=\"%s\" ", columns[i].c_str());
+                    for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++)
+                        if (double score; pooled(section, i, static_cast<VmafPoolingMethod>(method), &score))
+                            appendf(buffer, "%s=\"%.6f\" ", poolMethodName[method], score);
+                    buffer += "/>\n";
+                }
+
+                buffer += "    </segment>\n";
+            }
+
+            buffer += "  </segments>\n";
+        }
+
+        buffer += "</VMAF>\n";
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        buffer += "\n  ],\n";
+        buffer += "  \"pooled_metrics\": {";
+
+        for (size_t i{ 0 }; i < columns.size(); i++) {
+            buffer += i > 0 ? ",\n" : "\n";
+            appendf(buffer, "    \"%s\": {", columns[i].c_str());
+
+            for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++) {
+                if (double score; pooled(i, static_cast<VmafPoolingMethod>(method), &score)) {
+                    buffer += method > 1 ? ",\n" : "\n";
+                    appendf(buffer, "      \"%s\": ", poolMethodName[method]);
+                    appendf(buffer, "%.6f", score);
+                }
+            }
+
+            buffer += "\n";
+            buffer += "    }";
+        }
+
+        buffer += "\n  },\n";
+        buffer += "  \"aggregate_metrics\": {";
+
+        for (size_t i{ 0 }; i < aggregate.size(); i++) {
+            appendf(buffer, "%s\n    \"%s\": ", i > 0 ? "," : "", aggregate[i].first.c_str());
+            appendf(buffer, "%.6f", aggregate[i].second);
+        }
+
+        buffer += "\n  }";
+
+        if (!sections.empty()) {
+            buffer += ",\n";
+            buffer += "  \"segments\": [";
+
+            for (size_t s{ 0 }; s < sections.size(); s++) {
+                auto&& section{ sections[s] };
+
+                buffer += s > 0 ? ",\n" : "\n";
+                buffer += "    {\n";
+                appendf(buffer, "      \"first\": %u,\n", firstFrame + section.first);
+                appendf(buffer, "      \"last\": %u,\n", firstFrame + section.last);
+                buffer += "      \"pooled_metrics\": {";
+
+                for (size_t i{ 0 }; i < columns.size(); i++) {
+                    buffer += i > 0 ? ",\n" : "\n";
+                    appendf(buffer, "        \"%s\": {", columns[i].c_str());
+
+                    auto separator{ "" };
+                    for (auto method{ 1 }; method < VMAF_POOL_METHOD_NB; method++) {
+                        if (double score; pooled(section, i, static_cast<VmafPoolingMethod>(method), &score)) {
+                            appendf(buffer, "%s \"%s\": ", separator, poolMethodName[method]);
+                            appendf(buffer, "%.6f", score);
+                            separator = ",";
+                        }
+                    }
+
+                    buffer += " }";
+                }
+
+                buffer += "\n      }\n";
+                buffer += "    }";
+            }
+
+            buffer += "\n  ]";
+        }
+
+        buffer += "\n}\n";
+        break;
+    default:
+        break;
+    }
+
+    fwrite(buffer.data(), 1, buffer.size(), file);
+
+    return !ferror(file) && !fflush(file);
+}
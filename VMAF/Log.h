@@ -0,0 +1,181 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <libvmaf.h>
+}
+
+// libvmaf has no binary output, so the columnar layout of ScoreLog.h takes the value after its last format.
+static constexpr VmafOutputFormat outputFormatBinary{ static_cast<VmafOutputFormat>(VMAF_OUTPUT_FORMAT_SUB + 1) };
+
+// Running state of every pooling method for one metric, so a summary never needs the per-frame scores kept around.
+struct PooledScore final {
+    double min{ std::numeric_limits<double>::max() };
+    double max{ std::numeric_limits<double>::lowest() };
+    double sum{};
+    double harmonicSum{};
+    unsigned count{};
+
+    void add(double score) noexcept;
+    void merge(const PooledScore& other) noexcept;
+    bool pooled(VmafPoolingMethod method, double* score) const noexcept;
+};
+
+// Writes the log in the formats of libvmaf's vmaf_write_output while the frames are being scored, with the columns in the order
+// they are given, numbers printed the same way, and the header recording what this plugin adds, such as the range, crop and
+// sections. Rows arrive per segment, each a contiguous range of frames delivered in order, and are flushed to that segment's
+// spill file in batches. close() then assembles the header, the segments in frame order and the pooled metrics. Only a batch of
+// formatted rows per segment is held in memory.
+// The binary format needs no spill files: its size is known once the columns are, so each run of rows is scattered straight into
+// the columns of the log and close() only rewrites the header with the pooled metrics.
+//
+// Sections are the segments of the clip that are pooled on their own, e.g. shots. Their boundaries may only be known once the
+// frames around them have been scored, so rows are pooled per piece, a run of frames starting at a boundary or wherever a spill
+// segment starts, and close() merges the pieces into the sections it is given.
+class LogWriter final {
+    struct Segment final {
+        std::string path;
+        std::unique_ptr<FILE, decltype(&fclose)> file{ nullptr, fclose };
+        std::string buffer;
+        unsigned rows{};
+        unsigned runStart{};
+        unsigned runLength{};
+        std::vector<double> run;
+    };
+
+    struct Section final {
+        unsigned first;
+        unsigned last;
+        std::vector<PooledScore> pool;
+    };
+
+    std::string path;
+    VmafOutputFormat format;
+    unsigned width;
+    unsigned height;
+    unsigned numFrames;
+    unsigned firstFrame{};
+    std::array<int, 4> crop{};
+    bool cropDetected{};
+    bool preview{};
+    bool hasColumns{};
+    std::vector<std::string> columns;
+    std::vector<PooledScore> pool;
+    std::vector<Segment> segments;
+    bool sectioned{};
+    bool interpolation{};
+    bool flagColumn{};
+    std::vector<double> rowScore;
+    std::vector<bool> rowWritten;
+    std::map<unsigned, std::vector<PooledScore>> pieces;
+    std::vector<Section> sections;
+    std::unique_ptr<FILE, decltype(&fclose)> binary{ nullptr, fclose };
+    uint64_t dataOffset{};
+
+    bool cropped() const noexcept {
+        return cropDetected || crop[0] || crop[1] || crop[2] || crop[3];
+    }
+
+    bool pooled(const Section& section, size_t column, VmafPoolingMethod method, double* score) const noexcept {
+        return section.pool[column].count == section.last - section.first + 1 && section.pool[column].pooled(method, score);
+    }
+
+    void buildSections(const std::vector<unsigned>& starts);
+    bool writeSectionTable() const;
+    void appendRow(size_t segment, unsigned frame, unsigned piece, const std::vector<double>& score,
+                   const std::vector<bool>& written, bool interpolated);
+    void flush(Segment& segment);
+    bool flushRun(Segment& segment);
+    bool copyInto(FILE* dst, Segment& segment, long skip = 0);
+    bool writeBinaryHeader(double fps, uint64_t aggregateOffset, uint32_t numAggregates, uint64_t sectionOffset);
+    bool closeBinary(double fps, const std::vector<std::pair<std::string, double>>& aggregate);
+
+public:
+    LogWriter(const std::string& logPath, VmafOutputFormat logFormat, unsigned logWidth, unsigned logHeight,
+              unsigned frames) noexcept;
+    ~LogWriter();
+
+    // Creates the spill files. CSV and subtitle logs have no header that depends on the whole run, so the first segment goes
+    // straight into the log itself.
+    bool open(size_t numSegments);
+
+    // Region of the reference that was scored, recorded in the XML, JSON and binary log headers when anything was cropped.
+    void setCrop(int left, int right, int top, int bottom, bool detected) noexcept {
+        crop = { left, right, top, bottom };
+        cropDetected = detected;
+    }
+
+    // The pictures were downscaled for a quick approximate score, which the XML, JSON and binary headers record.
+    void setPreview() noexcept {
+        preview = true;
+    }
+
+    // Frames are appended by their index within the evaluated range, and written out as frame numbers of the clip.
+    void setFirstFrame(unsigned frame) noexcept {
+        firstFrame = frame;
+    }
+
+    // Pools every section on its own as well. Pieces are then passed to append() and the sections to close().
+    void trackSections() noexcept {
+        sectioned = true;
+    }
+
+    // Marks the frames whose scores were interpolated rather than computed. Must be called before setColumns().
+    void trackInterpolation() noexcept {
+        interpolation = true;
+    }
+
+    void setColumns(std::vector<std::string> aliases);
+    void append(size_t segment, unsigned frame, unsigned piece, const std::vector<double>& score,
+                const std::vector<bool>& written, bool interpolated = false);
+
+    const std::vector<std::string>& columnNames() const noexcept {
+        return columns;
+    }
+
+    const PooledScore& pooled(size_t column) const noexcept {
+        return pool[column];
+    }
+
+    // Mean of a metric is only reported when every frame of the clip has it, like vmaf_feature_score_pooled.
+    bool pooled(size_t column, VmafPoolingMethod method, double* score) const noexcept {
+        return pool[column].count == numFrames && pool[column].pooled(method, score);
+    }
+
+    // Sections start at the given frames, in ascending order and starting at 0, and each ends where the next one starts.
+    bool close(double fps, const std::vector<std::pair<std::string, double>>& aggregate,
+               const std::vector<unsigned>& sectionStarts);
+};
@@ -0,0 +1,88 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "PSNR.h"
+
+template<typename T, typename Row>
+static uint64_t sumOfSquaredErrors(const T* a, ptrdiff_t strideA, const T* b, ptrdiff_t strideB, unsigned width,
+                                   unsigned height) noexcept {
+    uint64_t total{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        // Widened per row so that 8-bit errors stay in 32-bit lanes.
+        Row row{};
+
+        for (unsigned x{ 0 }; x < width; x++) {
+            auto error{ static_cast<std::make_signed_t<Row>>(a[x]) - b[x] };
+            row += static_cast<Row>(error * error);
+        }
+
+        total += row;
+        a += strideA;
+        b += strideB;
+    }
+
+    return total;
+}
+
+static uint64_t sumOfSquaredErrors(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                   unsigned height, int bitsPerSample) noexcept {
+    if (bitsPerSample > 8)
+        return sumOfSquaredErrors<uint16_t, uint64_t>(static_cast<const uint16_t*>(a), strideA / 2,
+                                                      static_cast<const uint16_t*>(b), strideB / 2, width, height);
+    return sumOfSquaredErrors<uint8_t, uint32_t>(static_cast<const uint8_t*>(a), strideA, static_cast<const uint8_t*>(b), strideB,
+                                                 width, height);
+}
+
+using SquaredErrorKernel = uint64_t (*)(const void*, ptrdiff_t, const void*, ptrdiff_t, unsigned, unsigned, int) noexcept;
+
+static SquaredErrorKernel selectKernel() noexcept {
+#ifdef VMAF_X86
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return sumOfSquaredErrorsAVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return sumOfSquaredErrorsAVX2;
+#endif
+    return sumOfSquaredErrors;
+}
+
+double planePSNR(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                 unsigned width, unsigned height, int bitsPerSample) noexcept {
+    static const auto kernel{ selectKernel() };
+    auto total{ kernel(reference, referenceStride, distorted, distortedStride, width, height, bitsPerSample) };
+
+    auto peak{ static_cast<double>((1 << bitsPerSample) - 1) };
+    auto ceiling{ 6.0 * bitsPerSample + 12.0 };
+
+    if (!total)
+        return ceiling;
+
+    auto mse{ static_cast<double>(total) / (static_cast<double>(width) * height) };
+    return std::min(10.0 * std::log10(peak * peak / mse), ceiling);
+}
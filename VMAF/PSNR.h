@@ -0,0 +1,41 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// PSNR of a plane against the reference's, capped like libvmaf's psnr at 6 dB per bit plus 12 dB for identical planes. The
+// strides are in bytes, samples are 8-bit or 16-bit words holding bitsPerSample significant bits. The squared errors are summed
+// by the widest kernel the CPU supports.
+double planePSNR(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                 unsigned width, unsigned height, int bitsPerSample) noexcept;
+
+#ifdef VMAF_X86
+uint64_t sumOfSquaredErrorsAVX2(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                unsigned height, int bitsPerSample) noexcept;
+uint64_t sumOfSquaredErrorsAVX512(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                  unsigned height, int bitsPerSample) noexcept;
+#endif
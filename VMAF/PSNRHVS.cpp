@@ -0,0 +1,277 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "PSNRHVS.h"
+
+// Contrast sensitivity of the DCT coefficients of each plane, as in Daala. The 4:2:0 chroma tables serve every subsampling, like
+// in libvmaf.
+static constexpr float csfY[8][8]{
+    { 1.6193873005f, 2.2901594831f, 2.08509755623f, 1.48366094411f, 1.00227514334f, 0.678296995242f, 0.466224900598f, 0.3265091542f },
+    { 2.2901594831f, 1.94321815382f, 2.04793073064f, 1.68731108984f, 1.2305666963f, 0.868920337363f, 0.61280991668f, 0.436405793551f },
+    { 2.08509755623f, 2.04793073064f, 1.34329019223f, 1.09205635862f, 0.875748795257f, 0.670882927016f, 0.501731932449f, 0.372504254596f },
+    { 1.48366094411f, 1.68731108984f, 1.09205635862f, 0.772819797575f, 0.605636379554f, 0.48309405692f, 0.380429446972f, 0.295774038565f },
+    { 1.00227514334f, 1.2305666963f, 0.875748795257f, 0.605636379554f, 0.448996256676f, 0.352889268808f, 0.283006984131f, 0.226951348204f },
+    { 0.678296995242f, 0.868920337363f, 0.670882927016f, 0.48309405692f, 0.352889268808f, 0.27032073436f, 0.215017739696f, 0.17408067321f },
+    { 0.466224900598f, 0.61280991668f, 0.501731932449f, 0.380429446972f, 0.283006984131f, 0.215017739696f, 0.168869545842f, 0.136153931001f },
+    { 0.3265091542f, 0.436405793551f, 0.372504254596f, 0.295774038565f, 0.226951348204f, 0.17408067321f, 0.136153931001f, 0.109083846276f },
+};
+
+static constexpr float csfCb[8][8]{
+    { 1.91113096927f, 2.46074210438f, 1.18284184739f, 1.14982565193f, 1.05017074788f, 0.898018824055f, 0.74725392039f, 0.615105596242f },
+    { 2.46074210438f, 1.58529308355f, 1.21363250036f, 1.38190029285f, 1.33100189972f, 1.17428548929f, 0.996404342439f, 0.830890433625f },
+    { 1.18284184739f, 1.21363250036f, 0.978712413627f, 1.02624506078f, 1.03145147362f, 0.960060382087f, 0.849823426169f, 0.731221236837f },
+    { 1.14982565193f, 1.38190029285f, 1.02624506078f, 0.861317501629f, 0.801821139099f, 0.751437590932f, 0.685398513368f, 0.608694761374f },
+    { 1.05017074788f, 1.33100189972f, 1.03145147362f, 0.801821139099f, 0.676555426187f, 0.605503172737f, 0.55002013668f, 0.495804539034f },
+    { 0.898018824055f, 1.17428548929f, 0.960060382087f, 0.751437590932f, 0.605503172737f, 0.514674450957f, 0.454353482512f, 0.407050308965f },
+    { 0.74725392039f, 0.996404342439f, 0.849823426169f, 0.685398513368f, 0.55002013668f, 0.454353482512f, 0.389234902883f, 0.342353999733f },
+    { 0.615105596242f, 0.830890433625f, 0.731221236837f, 0.608694761374f, 0.495804539034f, 0.407050308965f, 0.342353999733f, 0.29553028752f },
+};
+
+static constexpr float csfCr[8][8]{
+    { 2.03871978502f, 2.62502345193f, 1.26180942886f, 1.11019789803f, 1.01397751469f, 0.867069376285f, 0.721500455585f, 0.593906509971f },
+    { 2.62502345193f, 1.69112867013f, 1.17180569821f, 1.3342742857f, 1.28513006198f, 1.13381474809f, 0.962064122248f, 0.802254508198f },
+    { 1.26180942886f, 1.17180569821f, 0.944981930573f, 0.990876405848f, 0.995903384143f, 0.926972725286f, 0.820534991409f, 0.706020324706f },
+    { 1.11019789803f, 1.3342742857f, 0.990876405848f, 0.831632933426f, 0.77418706195f, 0.725539939514f, 0.661776842059f, 0.587716619023f },
+    { 1.01397751469f, 1.28513006198f, 0.995903384143f, 0.77418706195f, 0.653238524286f, 0.584635025748f, 0.531064164893f, 0.478717061273f },
+    { 0.867069376285f, 1.13381474809f, 0.926972725286f, 0.725539939514f, 0.584635025748f, 0.496936637883f, 0.438694579826f, 0.393021669543f },
+    { 0.721500455585f, 0.962064122248f, 0.820534991409f, 0.661776842059f, 0.531064164893f, 0.438694579826f, 0.375820256136f, 0.330555063063f },
+    { 0.593906509971f, 0.802254508198f, 0.706020324706f, 0.587716619023f, 0.478717061273f, 0.393021669543f, 0.330555063063f, 0.285345396658f },
+};
+
+struct Weights final {
+    float csf[64];
+    float mask[64];
+};
+
+// The masking weights are the squares of the sensitivities scaled by Daala's constant, in double precision like libvmaf.
+static constexpr Weights weigh(const float (&csf)[8][8]) noexcept {
+    Weights weights{};
+
+    for (int i{ 0 }; i < 8; i++) {
+        for (int j{ 0 }; j < 8; j++) {
+            weights.csf[i * 8 + j] = csf[i][j];
+            weights.mask[i * 8 + j] = static_cast<float>((csf[i][j] * 0.3885746225901003) * (csf[i][j] * 0.3885746225901003));
+        }
+    }
+
+    return weights;
+}
+
+static constexpr Weights weights[]{ weigh(csfY), weigh(csfCb), weigh(csfCr) };
+
+// Daala's rounding shift, which rounds towards zero.
+static constexpr int32_t unbiasedShift(int32_t a, int b) noexcept {
+    return static_cast<int32_t>((static_cast<uint32_t>(a) >> (32 - b)) + static_cast<uint32_t>(a)) >> b;
+}
+
+// Daala's od_bin_fdct8: a reversible integer DCT-II of eight samples built from lifting steps, with orthonormal scaling.
+static void fdct8(int16_t* y, const int16_t* x, ptrdiff_t xStride) noexcept {
+    int32_t t0{ x[0] };
+    int32_t t4{ x[xStride] };
+    int32_t t2{ x[2 * xStride] };
+    int32_t t6{ x[3 * xStride] };
+    int32_t t7{ x[4 * xStride] };
+    int32_t t3{ x[5 * xStride] };
+    int32_t t5{ x[6 * xStride] };
+    int32_t t1{ x[7 * xStride] };
+
+    t1 = t0 - t1;
+    auto t1h{ unbiasedShift(t1, 1) };
+    t0 -= t1h;
+    t4 += t5;
+    auto t4h{ unbiasedShift(t4, 1) };
+    t5 -= t4h;
+    t3 = t2 - t3;
+    t2 -= unbiasedShift(t3, 1);
+    t6 += t7;
+    auto t6h{ unbiasedShift(t6, 1) };
+    t7 = t6h - t7;
+
+    t0 += t6h;
+    t6 = t0 - t6;
+    t2 = t4h - t2;
+    t4 = t2 - t4;
+
+    t0 -= (t4 * 13573 + 16384) >> 15;
+    t4 += (t0 * 11585 + 8192) >> 14;
+    t0 -= (t4 * 13573 + 16384) >> 15;
+
+    t6 -= (t2 * 21895 + 16384) >> 15;
+    t2 += (t6 * 15137 + 8192) >> 14;
+    t6 -= (t2 * 21895 + 16384) >> 15;
+
+    t3 += (t5 * 19195 + 16384) >> 15;
+    t5 += (t3 * 11585 + 8192) >> 14;
+    t3 -= (t5 * 7489 + 4096) >> 13;
+    t7 = unbiasedShift(t5, 1) - t7;
+    t5 -= t7;
+    t3 = t1h - t3;
+    t1 -= t3;
+
+    t7 += (t1 * 3227 + 16384) >> 15;
+    t1 -= (t7 * 6393 + 16384) >> 15;
+    t7 += (t1 * 3227 + 16384) >> 15;
+
+    t5 += (t3 * 2485 + 4096) >> 13;
+    t3 -= (t5 * 18205 + 16384) >> 15;
+    t5 += (t3 * 2485 + 4096) >> 13;
+
+    y[0] = static_cast<int16_t>(t0);
+    y[1] = static_cast<int16_t>(t1);
+    y[2] = static_cast<int16_t>(t2);
+    y[3] = static_cast<int16_t>(t3);
+    y[4] = static_cast<int16_t>(t4);
+    y[5] = static_cast<int16_t>(t5);
+    y[6] = static_cast<int16_t>(t6);
+    y[7] = static_cast<int16_t>(t7);
+}
+
+// Daala's od_bin_fdct8x8 in place: the columns go into the rows of an intermediate block, whose columns go into the rows of the
+// result.
+static void fdct8x8(int16_t* block) noexcept {
+    int16_t z[64];
+
+    for (int i{ 0 }; i < 8; i++)
+        fdct8(z + 8 * i, block + i, 8);
+    for (int i{ 0 }; i < 8; i++)
+        fdct8(block + 8 * i, z + i, 8);
+}
+
+using Transform = void (*)(int16_t*) noexcept;
+
+static Transform selectTransform() noexcept {
+#ifdef VMAF_X86
+    if (__builtin_cpu_supports("avx2"))
+        return fdct8x8AVX2;
+#endif
+    return fdct8x8;
+}
+
+// Masking of a block: the energy of its AC coefficients under the masking weights, scaled by how much of the block's variance is
+// local to its quadrants. The products of the coefficients are taken in integers, like in libvmaf.
+static float blockMask(const int16_t* samples, const int16_t* coefficients, const float* mask) noexcept {
+    float means[4]{};
+    float variances[4]{};
+    auto mean{ 0.0f };
+    auto variance{ 0.0f };
+
+    auto quadrant = [](int i, int j) {
+        return ((i & 4) >> 2) + ((j & 4) >> 1);
+    };
+
+    for (int i{ 0 }; i < 8; i++) {
+        for (int j{ 0 }; j < 8; j++) {
+            mean += samples[i * 8 + j];
+            means[quadrant(i, j)] += samples[i * 8 + j];
+        }
+    }
+
+    mean /= 64.0f;
+    for (auto&& m : means)
+        m /= 16.0f;
+
+    for (int i{ 0 }; i < 8; i++) {
+        for (int j{ 0 }; j < 8; j++) {
+            auto q{ quadrant(i, j) };
+            variance += (samples[i * 8 + j] - mean) * (samples[i * 8 + j] - mean);
+            variances[q] += (samples[i * 8 + j] - means[q]) * (samples[i * 8 + j] - means[q]);
+        }
+    }
+
+    variance *= 1.0f / 63.0f * 64.0f;
+    for (auto&& v : variances)
+        v *= 1.0f / 15.0f * 16.0f;
+
+    if (variance > 0.0f)
+        variance = (variances[0] + variances[1] + variances[2] + variances[3]) / variance;
+
+    auto energy{ 0.0f };
+    for (int k{ 1 }; k < 64; k++)
+        energy += coefficients[k] * coefficients[k] * mask[k];
+
+    return static_cast<float>(std::sqrt(static_cast<double>(energy * variance)) / 32.0f);
+}
+
+// Accumulated in single precision over the whole plane, in libvmaf's order.
+template<typename T>
+static double planeHVSError(const T* reference, ptrdiff_t referenceStride, const T* distorted, ptrdiff_t distortedStride,
+                            unsigned width, unsigned height, const Weights& weights) noexcept {
+    static const auto transform{ selectTransform() };
+
+    auto total{ 0.0f };
+    int count{};
+
+    for (unsigned y{ 0 }; y + 8 <= height; y += 7) {
+        for (unsigned x{ 0 }; x + 8 <= width; x += 7) {
+            alignas(32) int16_t s[64];
+            alignas(32) int16_t d[64];
+            alignas(32) int16_t sc[64];
+            alignas(32) int16_t dc[64];
+
+            for (int i{ 0 }; i < 8; i++) {
+                for (int j{ 0 }; j < 8; j++) {
+                    s[i * 8 + j] = static_cast<int16_t>(reference[(y + i) * referenceStride + x + j]);
+                    d[i * 8 + j] = static_cast<int16_t>(distorted[(y + i) * distortedStride + x + j]);
+                }
+            }
+
+            std::copy_n(s, 64, sc);
+            std::copy_n(d, 64, dc);
+            transform(sc);
+            transform(dc);
+
+            auto mask{ std::max(blockMask(s, sc, weights.mask), blockMask(d, dc, weights.mask)) };
+
+            for (int k{ 0 }; k < 64; k++) {
+                auto error{ static_cast<float>(std::abs(sc[k] - dc[k])) };
+                if (k)
+                    error = error < mask / weights.mask[k] ? 0.0f : error - mask / weights.mask[k];
+                total += (error * weights.csf[k]) * (error * weights.csf[k]);
+                count++;
+            }
+        }
+    }
+
+    return count ? total / count : 0.0f;
+}
+
+double planeHVSError(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                     unsigned width, unsigned height, int bitsPerSample, int plane) noexcept {
+    if (bitsPerSample > 8)
+        return planeHVSError(static_cast<const uint16_t*>(reference), referenceStride / 2,
+                             static_cast<const uint16_t*>(distorted), distortedStride / 2, width, height, weights[plane]);
+
+    return planeHVSError(static_cast<const uint8_t*>(reference), referenceStride, static_cast<const uint8_t*>(distorted),
+                         distortedStride, width, height, weights[plane]);
+}
+
+double hvsScore(double error, int bitsPerSample) noexcept {
+    auto peak{ (1 << bitsPerSample) - 1 };
+    auto ceiling{ 6.0 * bitsPerSample + 12.0 };
+    return error > 0.0 ? std::min(10.0 * (std::log10(peak * peak) - std::log10(error)), ceiling) : ceiling;
+}
@@ -0,0 +1,44 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// PSNR-HVS of a plane against the reference's, computed like libvmaf's psnr_hvs after Daala's dump_psnrhvs: 8x8 blocks every 7
+// samples, Daala's integer DCT, errors below the contrast masking of the block ignored and the rest weighted by the contrast
+// sensitivity of the plane. Strides are in bytes, samples are 8-bit or 16-bit words holding bitsPerSample significant bits.
+
+// Weighted mean squared error of plane 0, 1 or 2, to be combined across planes before conversion. Up to 12 bits, where the DCT
+// coefficients still fit libvmaf's 16-bit integers.
+double planeHVSError(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                     unsigned width, unsigned height, int bitsPerSample, int plane) noexcept;
+
+// The error in dB relative to the squared peak, capped like planePSNR so that identical planes score a finite value.
+double hvsScore(double error, int bitsPerSample) noexcept;
+
+#ifdef VMAF_X86
+void fdct8x8AVX2(int16_t* block) noexcept;
+#endif
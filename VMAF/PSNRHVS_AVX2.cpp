@@ -0,0 +1,145 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <immintrin.h>
+
+#include "PSNRHVS.h"
+
+static void transpose8x8(__m256i* rows) noexcept {
+    __m256i t[8];
+    __m256i u[8];
+
+    for (int i{ 0 }; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+    }
+
+    for (int i{ 0 }; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+
+    for (int i{ 0 }; i < 4; i++) {
+        rows[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        rows[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+}
+
+static __m256i unbiasedShift(__m256i a) noexcept {
+    return _mm256_srai_epi32(_mm256_add_epi32(a, _mm256_srli_epi32(a, 31)), 1);
+}
+
+// (a * m + bias) >> shift, the rounded product of each lifting step.
+template<int shift>
+static __m256i scale(__m256i a, int m) noexcept {
+    auto product{ _mm256_mullo_epi32(a, _mm256_set1_epi32(m)) };
+    return _mm256_srai_epi32(_mm256_add_epi32(product, _mm256_set1_epi32(1 << (shift - 1))), shift);
+}
+
+// Wraps to 16 bits like the coefficients stored between the passes.
+static __m256i truncate(__m256i a) noexcept {
+    return _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+}
+
+// The lifting steps of fdct8 on eight transforms at once, one per lane, x[k] holding sample k of each.
+static void fdct8(__m256i* x) noexcept {
+    auto t0{ x[0] };
+    auto t4{ x[1] };
+    auto t2{ x[2] };
+    auto t6{ x[3] };
+    auto t7{ x[4] };
+    auto t3{ x[5] };
+    auto t5{ x[6] };
+    auto t1{ x[7] };
+
+    t1 = _mm256_sub_epi32(t0, t1);
+    auto t1h{ unbiasedShift(t1) };
+    t0 = _mm256_sub_epi32(t0, t1h);
+    t4 = _mm256_add_epi32(t4, t5);
+    auto t4h{ unbiasedShift(t4) };
+    t5 = _mm256_sub_epi32(t5, t4h);
+    t3 = _mm256_sub_epi32(t2, t3);
+    t2 = _mm256_sub_epi32(t2, unbiasedShift(t3));
+    t6 = _mm256_add_epi32(t6, t7);
+    auto t6h{ unbiasedShift(t6) };
+    t7 = _mm256_sub_epi32(t6h, t7);
+
+    t0 = _mm256_add_epi32(t0, t6h);
+    t6 = _mm256_sub_epi32(t0, t6);
+    t2 = _mm256_sub_epi32(t4h, t2);
+    t4 = _mm256_sub_epi32(t2, t4);
+
+    t0 = _mm256_sub_epi32(t0, scale<15>(t4, 13573));
+    t4 = _mm256_add_epi32(t4, scale<14>(t0, 11585));
+    t0 = _mm256_sub_epi32(t0, scale<15>(t4, 13573));
+
+    t6 = _mm256_sub_epi32(t6, scale<15>(t2, 21895));
+    t2 = _mm256_add_epi32(t2, scale<14>(t6, 15137));
+    t6 = _mm256_sub_epi32(t6, scale<15>(t2, 21895));
+
+    t3 = _mm256_add_epi32(t3, scale<15>(t5, 19195));
+    t5 = _mm256_add_epi32(t5, scale<14>(t3, 11585));
+    t3 = _mm256_sub_epi32(t3, scale<13>(t5, 7489));
+    t7 = _mm256_sub_epi32(unbiasedShift(t5), t7);
+    t5 = _mm256_sub_epi32(t5, t7);
+    t3 = _mm256_sub_epi32(t1h, t3);
+    t1 = _mm256_sub_epi32(t1, t3);
+
+    t7 = _mm256_add_epi32(t7, scale<15>(t1, 3227));
+    t1 = _mm256_sub_epi32(t1, scale<15>(t7, 6393));
+    t7 = _mm256_add_epi32(t7, scale<15>(t1, 3227));
+
+    t5 = _mm256_add_epi32(t5, scale<13>(t3, 2485));
+    t3 = _mm256_sub_epi32(t3, scale<15>(t5, 18205));
+    t5 = _mm256_add_epi32(t5, scale<13>(t3, 2485));
+
+    x[0] = truncate(t0);
+    x[1] = truncate(t1);
+    x[2] = truncate(t2);
+    x[3] = truncate(t3);
+    x[4] = truncate(t4);
+    x[5] = truncate(t5);
+    x[6] = truncate(t6);
+    x[7] = truncate(t7);
+}
+
+// A row of the block per register widened to 32 bits, so the first pass transforms all columns at once. Transposing after each
+// pass gives the same result as the scalar od_bin_fdct8x8.
+void fdct8x8AVX2(int16_t* block) noexcept {
+    __m256i rows[8];
+
+    for (int i{ 0 }; i < 8; i++)
+        rows[i] = _mm256_cvtepi16_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(block + i * 8)));
+
+    fdct8(rows);
+    transpose8x8(rows);
+    fdct8(rows);
+    transpose8x8(rows);
+
+    for (int i{ 0 }; i < 8; i++)
+        _mm_store_si128(reinterpret_cast<__m128i*>(block + i * 8),
+                        _mm_packs_epi32(_mm256_castsi256_si128(rows[i]), _mm256_extracti128_si256(rows[i], 1)));
+}
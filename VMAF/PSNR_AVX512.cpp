@@ -0,0 +1,95 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <immintrin.h>
+
+#include "PSNR.h"
+
+// The AVX2 kernels at twice the width.
+static uint64_t sumOfSquaredErrors8(const uint8_t* a, ptrdiff_t strideA, const uint8_t* b, ptrdiff_t strideB, unsigned width,
+                                    unsigned height) noexcept {
+    auto total{ _mm512_setzero_si512() };
+    uint64_t tail{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        auto row{ _mm512_setzero_si512() };
+        unsigned x{ 0 };
+
+        for (; x + 32 <= width; x += 32) {
+            auto va{ _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x))) };
+            auto vb{ _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x))) };
+            auto error{ _mm512_sub_epi16(va, vb) };
+            row = _mm512_add_epi32(row, _mm512_madd_epi16(error, error));
+        }
+
+        for (; x < width; x++) {
+            auto error{ static_cast<int32_t>(a[x]) - b[x] };
+            tail += static_cast<uint32_t>(error * error);
+        }
+
+        total = _mm512_add_epi64(total, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(row)));
+        total = _mm512_add_epi64(total, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(row, 1)));
+        a += strideA;
+        b += strideB;
+    }
+
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(total)) + tail;
+}
+
+static uint64_t sumOfSquaredErrors16(const uint16_t* a, ptrdiff_t strideA, const uint16_t* b, ptrdiff_t strideB, unsigned width,
+                                     unsigned height) noexcept {
+    auto total{ _mm512_setzero_si512() };
+    uint64_t tail{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        unsigned x{ 0 };
+
+        for (; x + 16 <= width; x += 16) {
+            auto va{ _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x))) };
+            auto vb{ _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x))) };
+            auto error{ _mm512_sub_epi32(va, vb) };
+            auto odd{ _mm512_srli_epi64(error, 32) };
+            total = _mm512_add_epi64(total, _mm512_mul_epi32(error, error));
+            total = _mm512_add_epi64(total, _mm512_mul_epi32(odd, odd));
+        }
+
+        for (; x < width; x++) {
+            auto error{ static_cast<int64_t>(a[x]) - b[x] };
+            tail += static_cast<uint64_t>(error * error);
+        }
+
+        a += strideA;
+        b += strideB;
+    }
+
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(total)) + tail;
+}
+
+uint64_t sumOfSquaredErrorsAVX512(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                  unsigned height, int bitsPerSample) noexcept {
+    if (bitsPerSample > 8)
+        return sumOfSquaredErrors16(static_cast<const uint16_t*>(a), strideA / 2, static_cast<const uint16_t*>(b), strideB / 2,
+                                    width, height);
+    return sumOfSquaredErrors8(static_cast<const uint8_t*>(a), strideA, static_cast<const uint8_t*>(b), strideB, width, height);
+}
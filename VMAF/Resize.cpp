@@ -0,0 +1,228 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "Resize.h"
+
+static constexpr double pi{ 3.14159265358979323846 };
+
+// Mitchell-Netravali with b = c = 1/3, the default of VapourSynth's resize.Bicubic.
+static double bicubic(double x) noexcept {
+    constexpr double b{ 1.0 / 3.0 };
+    constexpr double c{ 1.0 / 3.0 };
+
+    x = std::abs(x);
+
+    if (x < 1.0)
+        return ((12.0 - 9.0 * b - 6.0 * c) * x * x * x + (-18.0 + 12.0 * b + 6.0 * c) * x * x + (6.0 - 2.0 * b)) / 6.0;
+    if (x < 2.0)
+        return ((-b - 6.0 * c) * x * x * x + (6.0 * b + 30.0 * c) * x * x + (-12.0 * b - 48.0 * c) * x + (8.0 * b + 24.0 * c)) /
+               6.0;
+    return 0.0;
+}
+
+// Three lobes, the default of VapourSynth's resize.Lanczos.
+static double lanczos(double x) noexcept {
+    constexpr double lobes{ 3.0 };
+
+    x = std::abs(x);
+
+    if (x < 1e-8)
+        return 1.0;
+    if (x < lobes)
+        return lobes * std::sin(pi * x) * std::sin(pi * x / lobes) / (pi * pi * x * x);
+    return 0.0;
+}
+
+// Taps of every destination sample, with the sample grids aligned on their centres and the edges replicated. When shrinking, the
+// kernel is stretched over the source so that it still low-passes.
+template<typename Kernel>
+static void makePass(unsigned taps, std::vector<unsigned>& index, std::vector<float>& weight, unsigned src, double start,
+                     double extent, unsigned dst, double radius, Kernel kernel) {
+    auto scale{ dst / extent };
+    auto stretch{ std::min(scale, 1.0) };
+    auto support{ radius / stretch };
+
+    index.resize(static_cast<size_t>(dst) * taps);
+    weight.resize(static_cast<size_t>(dst) * taps);
+
+    for (unsigned i{ 0 }; i < dst; i++) {
+        auto position{ start + (i + 0.5) / scale - 0.5 };
+        auto first{ static_cast<long>(std::floor(position - support)) + 1 };
+        auto sum{ 0.0 };
+
+        std::vector<double> w(taps);
+
+        for (unsigned k{ 0 }; k < taps; k++) {
+            w[k] = kernel((first + static_cast<long>(k) - position) * stretch);
+            sum += w[k];
+        }
+
+        for (unsigned k{ 0 }; k < taps; k++) {
+            index[i * taps + k] = static_cast<unsigned>(std::clamp(first + static_cast<long>(k), 0L, static_cast<long>(src) - 1));
+            weight[i * taps + k] = static_cast<float>(w[k] / sum);
+        }
+    }
+}
+
+PlaneResizer::PlaneResizer(Scaler scaler, unsigned sourceWidth, unsigned sourceHeight, double left, double top, double width,
+                           double height, unsigned destinationWidth, unsigned destinationHeight)
+    : dstWidth{ destinationWidth }, dstHeight{ destinationHeight } {
+    auto radius{ scaler == Scaler::lanczos ? 3.0 : 2.0 };
+    auto kernel{ scaler == Scaler::lanczos ? lanczos : bicubic };
+
+    auto tapsFor = [&](double extent, unsigned dst) {
+        return static_cast<unsigned>(std::ceil(radius / std::min(dst / extent, 1.0))) * 2;
+    };
+
+    horizontal.taps = tapsFor(width, dstWidth);
+    vertical.taps = tapsFor(height, dstHeight);
+
+    makePass(horizontal.taps, horizontal.index, horizontal.weight, sourceWidth, left, width, dstWidth, radius, kernel);
+    makePass(vertical.taps, vertical.index, vertical.weight, sourceHeight, top, height, dstHeight, radius, kernel);
+
+    // Only the rows the vertical taps reach are filtered horizontally, and only the columns the horizontal ones reach are read.
+    auto [low, high]{ std::minmax_element(vertical.index.cbegin(), vertical.index.cend()) };
+    rowFirst = *low;
+    rowCount = *high - *low + 1;
+
+    for (auto&& index : vertical.index)
+        index -= rowFirst;
+
+    auto [leftmost, rightmost]{ std::minmax_element(horizontal.index.cbegin(), horizontal.index.cend()) };
+    columnFirst = *leftmost;
+    columnCount = *rightmost - *leftmost + 1;
+
+    Pass transposed{ horizontal.taps, std::vector<unsigned>(horizontal.index.size()),
+                     std::vector<float>(horizontal.weight.size()) };
+
+    for (unsigned x{ 0 }; x < dstWidth; x++) {
+        for (unsigned k{ 0 }; k < horizontal.taps; k++) {
+            auto from{ static_cast<size_t>(x) * horizontal.taps + k };
+            auto to{ static_cast<size_t>(k) * dstWidth + x };
+
+            transposed.index[to] = horizontal.index[from] - columnFirst;
+            transposed.weight[to] = horizontal.weight[from];
+        }
+    }
+
+    horizontal = std::move(transposed);
+}
+
+template<typename T>
+void PlaneResizer::process(const T* src, ptrdiff_t srcStride, T* dst, ptrdiff_t dstStride, float peak) const noexcept {
+    thread_local std::vector<float> rows;
+    thread_local std::vector<float> sum;
+
+    rows.resize(static_cast<size_t>(rowCount) * dstWidth);
+    sum.resize(dstWidth);
+
+    srcStride /= sizeof(T);
+    dstStride /= sizeof(T);
+
+    for (unsigned y{ 0 }; y < rowCount; y++) {
+        auto srcp{ src + (rowFirst + y) * srcStride + columnFirst };
+        auto rowp{ rows.data() + static_cast<size_t>(y) * dstWidth };
+
+        for (unsigned x{ 0 }; x < dstWidth; x++) {
+            auto value{ 0.0f };
+
+            for (unsigned k{ 0 }; k < horizontal.taps; k++) {
+                auto tap{ static_cast<size_t>(k) * dstWidth + x };
+                value += horizontal.weight[tap] * static_cast<float>(srcp[horizontal.index[tap]]);
+            }
+
+            rowp[x] = value;
+        }
+    }
+
+    for (unsigned y{ 0 }; y < dstHeight; y++) {
+        auto index{ vertical.index.data() + static_cast<size_t>(y) * vertical.taps };
+        auto weight{ vertical.weight.data() + static_cast<size_t>(y) * vertical.taps };
+        auto sump{ sum.data() };
+
+        std::fill(sum.begin(), sum.end(), 0.0f);
+
+        for (unsigned k{ 0 }; k < vertical.taps; k++) {
+            auto rowp{ rows.data() + static_cast<size_t>(index[k]) * dstWidth };
+            auto w{ weight[k] };
+
+            for (unsigned x{ 0 }; x < dstWidth; x++)
+                sump[x] += w * rowp[x];
+        }
+
+        auto dstp{ dst + y * dstStride };
+
+        for (unsigned x{ 0 }; x < dstWidth; x++)
+            dstp[x] = static_cast<T>(std::min(std::max(sump[x] + 0.5f, 0.0f), peak));
+    }
+}
+
+void PlaneResizer::process(const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride,
+                           int bitsPerSample) const noexcept {
+#ifdef VMAF_X86
+    static const auto avx2{ !!__builtin_cpu_supports("avx2") };
+
+    if (avx2) {
+        resizePlaneAVX2(*this, src, srcStride, dst, dstStride, bitsPerSample);
+        return;
+    }
+#endif
+
+    auto peak{ static_cast<float>((1 << bitsPerSample) - 1) };
+
+    if (bitsPerSample > 8)
+        process(static_cast<const uint16_t*>(src), srcStride, static_cast<uint16_t*>(dst), dstStride, peak);
+    else
+        process(static_cast<const uint8_t*>(src), srcStride, static_cast<uint8_t*>(dst), dstStride, peak);
+}
+
+template<typename T>
+static void halvePlane(const T* src, ptrdiff_t srcStride, T* dst, ptrdiff_t dstStride, unsigned dstWidth,
+                       unsigned dstHeight) noexcept {
+    srcStride /= sizeof(T);
+    dstStride /= sizeof(T);
+
+    for (unsigned y{ 0 }; y < dstHeight; y++) {
+        auto top{ src + 2 * y * srcStride };
+        auto bottom{ top + srcStride };
+        auto dstp{ dst + y * dstStride };
+
+        for (unsigned x{ 0 }; x < dstWidth; x++)
+            dstp[x] =
+                static_cast<T>((static_cast<unsigned>(top[2 * x]) + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+    }
+}
+
+void halvePlane(const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride, unsigned dstWidth, unsigned dstHeight,
+                int bitsPerSample) noexcept {
+    if (bitsPerSample > 8)
+        halvePlane(static_cast<const uint16_t*>(src), srcStride, static_cast<uint16_t*>(dst), dstStride, dstWidth, dstHeight);
+    else
+        halvePlane(static_cast<const uint8_t*>(src), srcStride, static_cast<uint8_t*>(dst), dstStride, dstWidth, dstHeight);
+}
@@ -0,0 +1,83 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class Scaler {
+    bicubic,
+    lanczos
+};
+
+class PlaneResizer;
+
+#ifdef VMAF_X86
+void resizePlaneAVX2(const PlaneResizer& resizer, const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride,
+                     int bitsPerSample) noexcept;
+#endif
+
+// Separable resampling of a window of one plane to a fixed size. The taps of both passes are computed once, so scaling a frame is
+// only the two weighted sums: rows into a float intermediate of the destination width, then columns into the destination. The
+// horizontal taps are stored tap by tap across the destination row, so that eight outputs gather theirs at once, and the vertical
+// ones run along contiguous rows. The widest kernel the CPU supports sums them in the same order.
+class PlaneResizer final {
+    struct Pass final {
+        unsigned taps;
+        std::vector<unsigned> index;
+        std::vector<float> weight;
+    };
+
+    unsigned columnFirst;
+    unsigned columnCount;
+    unsigned rowFirst;
+    unsigned rowCount;
+    unsigned dstWidth;
+    unsigned dstHeight;
+    Pass horizontal;
+    Pass vertical;
+
+    template<typename T>
+    void process(const T* src, ptrdiff_t srcStride, T* dst, ptrdiff_t dstStride, float peak) const noexcept;
+
+#ifdef VMAF_X86
+    friend void resizePlaneAVX2(const PlaneResizer& resizer, const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride,
+                                int bitsPerSample) noexcept;
+#endif
+
+public:
+    // The window may be fractional and is given in source samples. Taps that fall outside it still read the source around it, and
+    // those outside the plane replicate its edges.
+    PlaneResizer(Scaler scaler, unsigned sourceWidth, unsigned sourceHeight, double left, double top, double width, double height,
+                 unsigned destinationWidth, unsigned destinationHeight);
+
+    // Strides are in bytes, samples are 8-bit or 16-bit words holding bitsPerSample significant bits.
+    void process(const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride, int bitsPerSample) const noexcept;
+};
+
+// Averages every 2x2 block of the source into one sample of the destination, rounding to nearest. The source must hold twice the
+// destination's width and height. Strides are in bytes.
+void halvePlane(const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride, unsigned dstWidth, unsigned dstHeight,
+                int bitsPerSample) noexcept;
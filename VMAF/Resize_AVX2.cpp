@@ -0,0 +1,149 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "Resize.h"
+
+static inline __m256 load8(const uint8_t* p) noexcept {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+}
+
+static inline __m256 load8(const uint16_t* p) noexcept {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+}
+
+// Packs eight samples that are already clamped to the peak.
+static inline void store8(uint8_t* p, __m256i v) noexcept {
+    auto words{ _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08)) };
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(words, words));
+}
+
+static inline void store8(uint16_t* p, __m256i v) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                     _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08)));
+}
+
+// The passes of PlaneResizer::process, eight destination samples at a time. Each source row is widened to floats once, so that
+// the horizontal taps can be gathered from it, and every sum adds the taps in the same order as the scalar loops.
+template<typename T>
+static void resize(const T* src, ptrdiff_t srcStride, T* dst, ptrdiff_t dstStride, float peak, unsigned taps,
+                   const unsigned* hIndex, const float* hWeight, unsigned vTaps, const unsigned* vIndex, const float* vWeight,
+                   unsigned columnFirst, unsigned columnCount, unsigned rowFirst, unsigned rowCount, unsigned dstWidth,
+                   unsigned dstHeight) noexcept {
+    thread_local std::vector<float> line;
+    thread_local std::vector<float> rows;
+
+    line.resize(columnCount);
+    rows.resize(static_cast<size_t>(rowCount) * dstWidth);
+
+    srcStride /= sizeof(T);
+    dstStride /= sizeof(T);
+
+    for (unsigned y{ 0 }; y < rowCount; y++) {
+        auto srcp{ src + (rowFirst + y) * srcStride + columnFirst };
+        auto rowp{ rows.data() + static_cast<size_t>(y) * dstWidth };
+        unsigned x{ 0 };
+
+        for (; x + 8 <= columnCount; x += 8)
+            _mm256_storeu_ps(line.data() + x, load8(srcp + x));
+        for (; x < columnCount; x++)
+            line[x] = static_cast<float>(srcp[x]);
+
+        for (x = 0; x + 8 <= dstWidth; x += 8) {
+            auto value{ _mm256_setzero_ps() };
+
+            for (unsigned k{ 0 }; k < taps; k++) {
+                auto tap{ static_cast<size_t>(k) * dstWidth + x };
+                auto index{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hIndex + tap)) };
+                auto sample{ _mm256_i32gather_ps(line.data(), index, 4) };
+                value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_loadu_ps(hWeight + tap), sample));
+            }
+
+            _mm256_storeu_ps(rowp + x, value);
+        }
+
+        for (; x < dstWidth; x++) {
+            auto value{ 0.0f };
+
+            for (unsigned k{ 0 }; k < taps; k++) {
+                auto tap{ static_cast<size_t>(k) * dstWidth + x };
+                value += hWeight[tap] * line[hIndex[tap]];
+            }
+
+            rowp[x] = value;
+        }
+    }
+
+    auto half{ _mm256_set1_ps(0.5f) };
+    auto zero{ _mm256_setzero_ps() };
+    auto top{ _mm256_set1_ps(peak) };
+
+    for (unsigned y{ 0 }; y < dstHeight; y++) {
+        auto index{ vIndex + static_cast<size_t>(y) * vTaps };
+        auto weight{ vWeight + static_cast<size_t>(y) * vTaps };
+        auto dstp{ dst + y * dstStride };
+        unsigned x{ 0 };
+
+        for (; x + 8 <= dstWidth; x += 8) {
+            auto value{ _mm256_setzero_ps() };
+
+            for (unsigned k{ 0 }; k < vTaps; k++) {
+                auto rowp{ rows.data() + static_cast<size_t>(index[k]) * dstWidth };
+                value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_set1_ps(weight[k]), _mm256_loadu_ps(rowp + x)));
+            }
+
+            value = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(value, half), zero), top);
+            store8(dstp + x, _mm256_cvttps_epi32(value));
+        }
+
+        for (; x < dstWidth; x++) {
+            auto value{ 0.0f };
+
+            for (unsigned k{ 0 }; k < vTaps; k++)
+                value += weight[k] * rows[static_cast<size_t>(index[k]) * dstWidth + x];
+
+            dstp[x] = static_cast<T>(std::min(std::max(value + 0.5f, 0.0f), peak));
+        }
+    }
+}
+
+void resizePlaneAVX2(const PlaneResizer& resizer, const void* src, ptrdiff_t srcStride, void* dst, ptrdiff_t dstStride,
+                     int bitsPerSample) noexcept {
+    auto&& r{ resizer };
+    auto peak{ static_cast<float>((1 << bitsPerSample) - 1) };
+
+    if (bitsPerSample > 8)
+        resize(static_cast<const uint16_t*>(src), srcStride, static_cast<uint16_t*>(dst), dstStride, peak, r.horizontal.taps,
+               r.horizontal.index.data(), r.horizontal.weight.data(), r.vertical.taps, r.vertical.index.data(),
+               r.vertical.weight.data(), r.columnFirst, r.columnCount, r.rowFirst, r.rowCount, r.dstWidth, r.dstHeight);
+    else
+        resize(static_cast<const uint8_t*>(src), srcStride, static_cast<uint8_t*>(dst), dstStride, peak, r.horizontal.taps,
+               r.horizontal.index.data(), r.horizontal.weight.data(), r.vertical.taps, r.vertical.index.data(),
+               r.vertical.weight.data(), r.columnFirst, r.columnCount, r.rowFirst, r.rowCount, r.dstWidth, r.dstHeight);
+}
@@ -0,0 +1,346 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "SSIM.h"
+
+static constexpr unsigned windowSize{ 11 };
+static constexpr float c1{ 0.01f * 255.0f * 0.01f * 255.0f };
+static constexpr float c2{ 0.03f * 255.0f * 0.03f * 255.0f };
+static constexpr float c3{ c2 / 2.0f };
+
+static const std::array<float, windowSize> window{ [] {
+    std::array<float, windowSize> taps{};
+    double sum{};
+
+    for (unsigned i{ 0 }; i < windowSize; i++)
+        sum += taps[i] = static_cast<float>(std::exp(-((i - 5.0) * (i - 5.0)) / (2.0 * 1.5 * 1.5)));
+    for (auto&& tap : taps)
+        tap = static_cast<float>(tap / sum);
+
+    return taps;
+}() };
+
+// Low-pass half of the 9/7 biorthogonal wavelet, normalized to unit gain.
+static const std::vector<float> waveletLowPass{ [] {
+    std::vector<float> taps{ 0.037828f, -0.023849f, -0.110624f, 0.377403f, 0.852699f, 0.377403f, -0.110624f, -0.023849f,
+                             0.037828f };
+    float sum{};
+
+    for (auto&& tap : taps)
+        sum += tap;
+    for (auto&& tap : taps)
+        tap /= sum;
+
+    return taps;
+}() };
+
+struct Image final {
+    unsigned width;
+    unsigned height;
+    std::vector<float> data;
+
+    void resize(unsigned w, unsigned h) {
+        width = w;
+        height = h;
+        data.resize(static_cast<size_t>(w) * h);
+    }
+
+    float* row(unsigned y) noexcept {
+        return data.data() + static_cast<size_t>(y) * width;
+    }
+
+    const float* row(unsigned y) const noexcept {
+        return data.data() + static_cast<size_t>(y) * width;
+    }
+};
+
+// Means of the first image, the second, their squares and their product under the window. A struct of planes rather than of
+// samples so that the passes run along contiguous rows.
+struct Moments final {
+    Image a;
+    Image b;
+    Image aa;
+    Image bb;
+    Image ab;
+};
+
+template<typename T>
+static void toFloat(const T* src, ptrdiff_t stride, unsigned width, unsigned height, float scale, Image& dst) {
+    dst.resize(width, height);
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        auto srcp{ src + y * stride };
+        auto dstp{ dst.row(y) };
+
+        for (unsigned x{ 0 }; x < width; x++)
+            dstp[x] = srcp[x] * scale;
+    }
+}
+
+static void toFloat(const void* src, ptrdiff_t stride, unsigned width, unsigned height, int bitsPerSample, Image& dst) {
+    if (bitsPerSample > 8)
+        toFloat(static_cast<const uint16_t*>(src), stride / 2, width, height, 1.0f / (1 << (bitsPerSample - 8)), dst);
+    else
+        toFloat(static_cast<const uint8_t*>(src), stride, width, height, 1.0f, dst);
+}
+
+static unsigned mirror(int i, unsigned size) noexcept {
+    if (i < 0)
+        return -i - 1;
+    if (i >= static_cast<int>(size))
+        return 2 * size - i - 1;
+    return i;
+}
+
+// Filters the image with the separable taps at every factor-th sample, starting with the first, with the edges mirrored. The taps
+// are centred on the sample, or on the one after the middle of an even number of them.
+static void decimate(const Image& src, unsigned factor, const std::vector<float>& taps, Image& dst) {
+    thread_local Image rows;
+
+    auto first{ -static_cast<int>(taps.size() / 2) };
+    rows.resize((src.width + factor - 1) / factor, src.height);
+    dst.resize(rows.width, (src.height + factor - 1) / factor);
+
+    for (unsigned y{ 0 }; y < src.height; y++) {
+        auto srcp{ src.row(y) };
+        auto rowp{ rows.row(y) };
+
+        for (unsigned x{ 0 }; x < rows.width; x++) {
+            auto sum{ 0.0f };
+            for (size_t k{ 0 }; k < taps.size(); k++)
+                sum += taps[k] * srcp[mirror(static_cast<int>(x * factor) + first + static_cast<int>(k), src.width)];
+            rowp[x] = sum;
+        }
+    }
+
+    for (unsigned y{ 0 }; y < dst.height; y++) {
+        auto dstp{ dst.row(y) };
+        std::fill_n(dstp, dst.width, 0.0f);
+
+        for (size_t k{ 0 }; k < taps.size(); k++) {
+            auto rowp{ rows.row(mirror(static_cast<int>(y * factor) + first + static_cast<int>(k), src.height)) };
+            auto tap{ taps[k] };
+
+            for (unsigned x{ 0 }; x < dst.width; x++)
+                dstp[x] += tap * rowp[x];
+        }
+    }
+}
+
+static void moments(const Image& a, const Image& b, Moments& m) {
+    thread_local Moments rows;
+
+    auto width{ a.width - windowSize + 1 };
+    auto height{ a.height - windowSize + 1 };
+
+    for (auto image : { &rows.a, &rows.b, &rows.aa, &rows.bb, &rows.ab })
+        image->resize(width, a.height);
+    for (auto image : { &m.a, &m.b, &m.aa, &m.bb, &m.ab })
+        image->resize(width, height);
+
+    thread_local std::vector<float> squares;
+    squares.resize(static_cast<size_t>(a.width) * 3);
+
+    auto aa{ squares.data() };
+    auto bb{ aa + a.width };
+    auto ab{ bb + a.width };
+
+    // The window is applied one tap at a time across the row so that every pass runs along contiguous samples.
+    for (unsigned y{ 0 }; y < a.height; y++) {
+        auto ap{ a.row(y) };
+        auto bp{ b.row(y) };
+
+        for (unsigned x{ 0 }; x < a.width; x++) {
+            aa[x] = ap[x] * ap[x];
+            bb[x] = bp[x] * bp[x];
+            ab[x] = ap[x] * bp[x];
+        }
+
+        std::array<std::pair<const float*, float*>, 5> sums{
+            { { ap, rows.a.row(y) }, { bp, rows.b.row(y) }, { aa, rows.aa.row(y) }, { bb, rows.bb.row(y) },
+              { ab, rows.ab.row(y) } }
+        };
+
+        for (auto&& [srcp, dstp] : sums) {
+            std::fill_n(dstp, width, 0.0f);
+
+            for (unsigned k{ 0 }; k < windowSize; k++) {
+                auto w{ window[k] };
+                for (unsigned x{ 0 }; x < width; x++)
+                    dstp[x] += w * srcp[x + k];
+            }
+        }
+    }
+
+    std::array<std::pair<const Image*, Image*>, 5> passes{
+        { { &rows.a, &m.a }, { &rows.b, &m.b }, { &rows.aa, &m.aa }, { &rows.bb, &m.bb }, { &rows.ab, &m.ab } }
+    };
+
+    for (auto&& [src, dst] : passes) {
+        for (unsigned y{ 0 }; y < height; y++) {
+            auto dstp{ dst->row(y) };
+            std::fill_n(dstp, width, 0.0f);
+
+            for (unsigned k{ 0 }; k < windowSize; k++) {
+                auto srcp{ src->row(y + k) };
+                auto w{ window[k] };
+
+                for (unsigned x{ 0 }; x < width; x++)
+                    dstp[x] += w * srcp[x];
+            }
+        }
+    }
+}
+
+static unsigned ssimScale(unsigned width, unsigned height) noexcept {
+    return std::max(1u, static_cast<unsigned>(std::lround(std::min(width, height) / 256.0)));
+}
+
+void ssimMapSize(unsigned width, unsigned height, unsigned* mapWidth, unsigned* mapHeight) noexcept {
+    auto scale{ ssimScale(width, height) };
+    *mapWidth = (width + scale - 1) / scale - windowSize + 1;
+    *mapHeight = (height + scale - 1) / scale - windowSize + 1;
+}
+
+double planeSSIM(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                 unsigned width, unsigned height, int bitsPerSample, float* map, ptrdiff_t mapStride) {
+    thread_local Image a;
+    thread_local Image b;
+    thread_local Image shrunk;
+    thread_local Moments m;
+
+    toFloat(reference, referenceStride, width, height, bitsPerSample, a);
+    toFloat(distorted, distortedStride, width, height, bitsPerSample, b);
+
+    if (auto scale{ ssimScale(width, height) }; scale > 1) {
+        std::vector<float> box(scale, 1.0f / scale);
+
+        decimate(a, scale, box, shrunk);
+        std::swap(a, shrunk);
+        decimate(b, scale, box, shrunk);
+        std::swap(b, shrunk);
+    }
+
+    moments(a, b, m);
+
+    double total{};
+
+    for (unsigned y{ 0 }; y < m.a.height; y++) {
+        auto mu1{ m.a.row(y) };
+        auto mu2{ m.b.row(y) };
+        auto aa{ m.aa.row(y) };
+        auto bb{ m.bb.row(y) };
+        auto ab{ m.ab.row(y) };
+        auto mapp{ map ? reinterpret_cast<float*>(reinterpret_cast<char*>(map) + y * mapStride) : nullptr };
+        auto row{ 0.0f };
+
+        for (unsigned x{ 0 }; x < m.a.width; x++) {
+            auto mu11{ mu1[x] * mu1[x] };
+            auto mu22{ mu2[x] * mu2[x] };
+            auto mu12{ mu1[x] * mu2[x] };
+            auto ssim{ (2.0f * mu12 + c1) * (2.0f * (ab[x] - mu12) + c2) /
+                       ((mu11 + mu22 + c1) * (aa[x] - mu11 + bb[x] - mu22 + c2)) };
+
+            row += ssim;
+            if (mapp)
+                mapp[x] = ssim;
+        }
+
+        total += row;
+    }
+
+    return total / (static_cast<double>(m.a.width) * m.a.height);
+}
+
+double planeMSSSIM(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                   unsigned width, unsigned height, int bitsPerSample) {
+    static constexpr double exponent[]{ 0.0448, 0.2856, 0.3001, 0.2363, 0.1333 };
+
+    thread_local Image a;
+    thread_local Image b;
+    thread_local Image shrunk;
+    thread_local Moments m;
+
+    toFloat(reference, referenceStride, width, height, bitsPerSample, a);
+    toFloat(distorted, distortedStride, width, height, bitsPerSample, b);
+
+    auto msssim{ 1.0 };
+
+    for (unsigned scale{ 0 }; scale < 5; scale++) {
+        moments(a, b, m);
+
+        double luminance{};
+        double contrast{};
+        double structure{};
+
+        for (unsigned y{ 0 }; y < m.a.height; y++) {
+            auto mu1{ m.a.row(y) };
+            auto mu2{ m.b.row(y) };
+            auto aa{ m.aa.row(y) };
+            auto bb{ m.bb.row(y) };
+            auto ab{ m.ab.row(y) };
+            auto l{ 0.0f };
+            auto c{ 0.0f };
+            auto s{ 0.0f };
+
+            for (unsigned x{ 0 }; x < m.a.width; x++) {
+                auto sigma1{ std::sqrt(std::max(aa[x] - mu1[x] * mu1[x], 0.0f)) };
+                auto sigma2{ std::sqrt(std::max(bb[x] - mu2[x] * mu2[x], 0.0f)) };
+                auto sigma12{ ab[x] - mu1[x] * mu2[x] };
+
+                l += (2.0f * mu1[x] * mu2[x] + c1) / (mu1[x] * mu1[x] + mu2[x] * mu2[x] + c1);
+                c += (2.0f * sigma1 * sigma2 + c2) / (sigma1 * sigma1 + sigma2 * sigma2 + c2);
+                s += (sigma12 + c3) / (sigma1 * sigma2 + c3);
+            }
+
+            luminance += l;
+            contrast += c;
+            structure += s;
+        }
+
+        auto samples{ static_cast<double>(m.a.width) * m.a.height };
+
+        // A negative mean structure would make the power undefined; it only happens for inverted content and scores as zero.
+        msssim *= std::pow(std::max(contrast / samples, 0.0), exponent[scale]) *
+                  std::pow(std::max(structure / samples, 0.0), exponent[scale]);
+
+        if (scale == 4) {
+            msssim *= std::pow(std::max(luminance / samples, 0.0), exponent[scale]);
+            break;
+        }
+
+        decimate(a, 2, waveletLowPass, shrunk);
+        std::swap(a, shrunk);
+        decimate(b, 2, waveletLowPass, shrunk);
+        std::swap(b, shrunk);
+    }
+
+    return msssim;
+}
@@ -0,0 +1,46 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+// Structural similarity of a luma plane against the reference's, computed like libvmaf's float_ssim and float_ms_ssim: samples
+// scaled to 8 bits, an 11x11 Gaussian window with a sigma of 1.5 applied wherever it fits completely, K1 = 0.01 and K2 = 0.03.
+// Strides are in bytes, samples are 8-bit or 16-bit words holding bitsPerSample significant bits.
+
+// Smallest width and height MS-SSIM accepts, so that the window still fits the fifth scale.
+static constexpr unsigned msssimMinimumSize{ 176 };
+
+// Size of the map planeSSIM writes. Like float_ssim, planes of more than about 384 samples in their shorter direction are first
+// shrunk by an integer factor, and the map then loses the border the window does not fit into.
+void ssimMapSize(unsigned width, unsigned height, unsigned* mapWidth, unsigned* mapHeight) noexcept;
+
+// Mean SSIM. With a map, the SSIM of every window position is written to it as well.
+double planeSSIM(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                 unsigned width, unsigned height, int bitsPerSample, float* map = nullptr, ptrdiff_t mapStride = 0);
+
+// MS-SSIM over five scales, each halved with the 9/7 wavelet's low-pass filter, with the exponents of Wang et al.
+double planeMSSSIM(const void* reference, ptrdiff_t referenceStride, const void* distorted, ptrdiff_t distortedStride,
+                   unsigned width, unsigned height, int bitsPerSample);
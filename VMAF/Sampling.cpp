@@ -0,0 +1,107 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "Sampling.h"
+
+StratifiedSample::StratifiedSample(unsigned frames, unsigned numStrata)
+    : length{ frames / numStrata }, remainder{ frames % numStrata } {
+    for (unsigned i{ 0 }; i < numStrata; i++)
+        strata.push_back({ i * length + std::min(i, remainder), length + (i < remainder), 0, 0.0, 0.0 });
+}
+
+size_t StratifiedSample::stratum(unsigned frame) const noexcept {
+    auto wide{ remainder * (length + 1) };
+    return frame < wide ? frame / (length + 1) : remainder + (frame - wide) / length;
+}
+
+std::vector<unsigned> StratifiedSample::order(uint32_t seed) const {
+    std::mt19937 engine{ seed };
+    std::vector<std::vector<unsigned>> frames(strata.size());
+
+    for (size_t i{ 0 }; i < strata.size(); i++) {
+        frames[i].resize(strata[i].size);
+        std::iota(frames[i].begin(), frames[i].end(), strata[i].first);
+        std::shuffle(frames[i].begin(), frames[i].end(), engine);
+    }
+
+    std::vector<size_t> visit(strata.size());
+    std::iota(visit.begin(), visit.end(), 0);
+
+    std::vector<unsigned> drawn;
+
+    for (unsigned round{ 0 }; round <= length; round++) {
+        std::shuffle(visit.begin(), visit.end(), engine);
+
+        for (auto&& i : visit)
+            if (round < strata[i].size)
+                drawn.push_back(frames[i][round]);
+    }
+
+    return drawn;
+}
+
+void StratifiedSample::add(unsigned frame, double score) noexcept {
+    auto& s{ strata[stratum(frame)] };
+    auto delta{ score - s.mean };
+
+    s.count++;
+    s.mean += delta / s.count;
+    s.squares += delta * (score - s.mean);
+    count++;
+}
+
+bool StratifiedSample::estimate(double confidence, double* mean, double* halfWidth) const noexcept {
+    double total{ static_cast<double>(strata.back().first + strata.back().size) };
+    double sum{};
+    double variance{};
+
+    for (auto&& s : strata) {
+        if (s.count < std::min(s.size, 2u))
+            return false;
+
+        auto weight{ s.size / total };
+        sum += weight * s.mean;
+
+        if (s.count < s.size)
+            variance += weight * weight * (1.0 - static_cast<double>(s.count) / s.size) * s.squares / (s.count - 1) / s.count;
+    }
+
+    // Two-sided critical value of the standard normal distribution, found by bisection on its tail probability.
+    double low{ 0.0 };
+    double high{ 10.0 };
+
+    for (auto i{ 0 }; i < 64; i++) {
+        auto z{ (low + high) / 2.0 };
+        (std::erfc(z / std::sqrt(2.0)) > 1.0 - confidence ? low : high) = z;
+    }
+
+    *mean = sum;
+    *halfWidth = low * std::sqrt(variance);
+    return true;
+}
@@ -0,0 +1,64 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Splits a clip into strata of consecutive frames that differ in size by at most one and estimates the mean of a per-frame score
+// from a random subset of them. Frames are drawn in rounds, each taking one frame at random from every stratum that has any left
+// and visiting the strata in a random order, so however early the sampling stops the frames drawn are spread over the whole clip.
+class StratifiedSample final {
+    struct Stratum final {
+        unsigned first;
+        unsigned size;
+        unsigned count;
+        double mean;
+        double squares;
+    };
+
+    std::vector<Stratum> strata;
+    unsigned length;
+    unsigned remainder;
+    unsigned count{};
+
+    size_t stratum(unsigned frame) const noexcept;
+
+public:
+    StratifiedSample(unsigned frames, unsigned numStrata);
+
+    // Every frame of the clip in the order it is drawn.
+    std::vector<unsigned> order(uint32_t seed) const;
+
+    void add(unsigned frame, double score) noexcept;
+
+    unsigned frames() const noexcept {
+        return count;
+    }
+
+    // Stratified mean of the scores added so far and the half width of its confidence interval at the given level, by the normal
+    // approximation with the finite population correction. Only available once each stratum has two scores or all its frames.
+    bool estimate(double confidence, double* mean, double* halfWidth) const noexcept;
+};
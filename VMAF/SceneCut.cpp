@@ -0,0 +1,73 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstdint>
+
+#include "SceneCut.h"
+
+template<typename T>
+static uint64_t sumOfDifferences(const T* a, ptrdiff_t strideA, const T* b, ptrdiff_t strideB, unsigned width,
+                                 unsigned height) noexcept {
+    uint64_t total{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        // Widened per row so that the inner loop stays in 32-bit lanes.
+        uint32_t row{};
+
+        for (unsigned x{ 0 }; x < width; x++)
+            row += a[x] > b[x] ? a[x] - b[x] : b[x] - a[x];
+
+        total += row;
+        a += strideA;
+        b += strideB;
+    }
+
+    return total;
+}
+
+static uint64_t sumOfDifferences(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                 unsigned height, int bitsPerSample) noexcept {
+    if (bitsPerSample > 8)
+        return sumOfDifferences(static_cast<const uint16_t*>(a), strideA / 2, static_cast<const uint16_t*>(b), strideB / 2,
+                                width, height);
+    return sumOfDifferences(static_cast<const uint8_t*>(a), strideA, static_cast<const uint8_t*>(b), strideB, width, height);
+}
+
+using DifferenceKernel = uint64_t (*)(const void*, ptrdiff_t, const void*, ptrdiff_t, unsigned, unsigned, int) noexcept;
+
+static DifferenceKernel selectKernel() noexcept {
+#ifdef VMAF_X86
+    if (__builtin_cpu_supports("avx2"))
+        return sumOfAbsoluteDifferencesAVX2;
+#endif
+    return sumOfDifferences;
+}
+
+double lumaDifference(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width, unsigned height,
+                      int bitsPerSample) noexcept {
+    static const auto kernel{ selectKernel() };
+    auto total{ kernel(a, strideA, b, strideB, width, height, bitsPerSample) };
+
+    return static_cast<double>(total) / (static_cast<double>(width) * height * ((1 << bitsPerSample) - 1));
+}
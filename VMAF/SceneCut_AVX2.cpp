@@ -0,0 +1,95 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <immintrin.h>
+
+#include "SceneCut.h"
+
+// psadbw sums the 8-bit differences of every eight samples straight into 64-bit lanes.
+static uint64_t sumOfDifferences8(const uint8_t* a, ptrdiff_t strideA, const uint8_t* b, ptrdiff_t strideB, unsigned width,
+                                  unsigned height) noexcept {
+    auto total{ _mm256_setzero_si256() };
+    uint64_t tail{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        unsigned x{ 0 };
+
+        for (; x + 32 <= width; x += 32) {
+            auto va{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x)) };
+            auto vb{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x)) };
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(va, vb));
+        }
+
+        for (; x < width; x++)
+            tail += a[x] > b[x] ? a[x] - b[x] : b[x] - a[x];
+
+        a += strideA;
+        b += strideB;
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail;
+}
+
+// Wider differences are taken with saturating subtractions both ways and summed in 32-bit lanes, which hold a row of any
+// realistic width before being widened.
+static uint64_t sumOfDifferences16(const uint16_t* a, ptrdiff_t strideA, const uint16_t* b, ptrdiff_t strideB, unsigned width,
+                                   unsigned height) noexcept {
+    auto total{ _mm256_setzero_si256() };
+    auto low{ _mm256_set1_epi32(0xFFFF) };
+    uint64_t tail{};
+
+    for (unsigned y{ 0 }; y < height; y++) {
+        auto row{ _mm256_setzero_si256() };
+        unsigned x{ 0 };
+
+        for (; x + 16 <= width; x += 16) {
+            auto va{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x)) };
+            auto vb{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x)) };
+            auto difference{ _mm256_or_si256(_mm256_subs_epu16(va, vb), _mm256_subs_epu16(vb, va)) };
+            row = _mm256_add_epi32(row, _mm256_add_epi32(_mm256_and_si256(difference, low), _mm256_srli_epi32(difference, 16)));
+        }
+
+        for (; x < width; x++)
+            tail += a[x] > b[x] ? a[x] - b[x] : b[x] - a[x];
+
+        total = _mm256_add_epi64(total, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(row)));
+        total = _mm256_add_epi64(total, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(row, 1)));
+        a += strideA;
+        b += strideB;
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail;
+}
+
+uint64_t sumOfAbsoluteDifferencesAVX2(const void* a, ptrdiff_t strideA, const void* b, ptrdiff_t strideB, unsigned width,
+                                      unsigned height, int bitsPerSample) noexcept {
+    if (bitsPerSample > 8)
+        return sumOfDifferences16(static_cast<const uint16_t*>(a), strideA / 2, static_cast<const uint16_t*>(b), strideB / 2,
+                                  width, height);
+    return sumOfDifferences8(static_cast<const uint8_t*>(a), strideA, static_cast<const uint8_t*>(b), strideB, width, height);
+}
@@ -0,0 +1,289 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#include "ScoreCache.h"
+
+static constexpr char cacheMagic[]{ "VMAFSC01" };
+
+enum RecordType : uint32_t {
+    recordColumns = 1,
+    recordRow
+};
+
+struct RecordHeader final {
+    uint32_t type;
+    uint32_t count;
+    uint64_t key;
+    uint64_t size;
+};
+
+static uint64_t padded(uint64_t size) noexcept {
+    return (size + 7) & ~uint64_t{ 7 };
+}
+
+static bool seek(FILE* file, uint64_t offset, int origin = SEEK_SET) noexcept {
+#ifdef _WIN32
+    return !_fseeki64(file, static_cast<__int64>(offset), origin);
+#else
+    return !fseeko(file, static_cast<off_t>(offset), origin);
+#endif
+}
+
+static uint64_t tell(FILE* file) noexcept {
+#ifdef _WIN32
+    return static_cast<uint64_t>(_ftelli64(file));
+#else
+    return static_cast<uint64_t>(ftello(file));
+#endif
+}
+
+static bool truncateFile(FILE* file, uint64_t size) noexcept {
+    if (std::fflush(file))
+        return false;
+#ifdef _WIN32
+    return !_chsize_s(_fileno(file), static_cast<__int64>(size));
+#else
+    return !ftruncate(fileno(file), static_cast<off_t>(size));
+#endif
+}
+
+// An advisory lock on the whole file, held while a run appends to it so that runs sharing a cache do not interleave their
+// records. Whatever is buffered is written out before the lock is released.
+class FileLock final {
+    FILE* file;
+    bool held;
+
+    bool lock(bool exclusive) noexcept {
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        auto handle{ reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))) };
+        return exclusive ? LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped)
+                         : UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+#else
+        return !flock(fileno(file), exclusive ? LOCK_EX : LOCK_UN);
+#endif
+    }
+
+public:
+    explicit FileLock(FILE* lockedFile) noexcept : file{ lockedFile } {
+        held = lock(true);
+    }
+
+    ~FileLock() {
+        if (held) {
+            std::fflush(file);
+            lock(false);
+        }
+    }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    bool locked() const noexcept {
+        return held;
+    }
+};
+
+uint64_t ScoreCache::scan(FILE* file, uint64_t offset) {
+    if (!seek(file, offset))
+        return offset;
+
+    std::vector<char> payload;
+
+    for (RecordHeader header; std::fread(&header, sizeof(header), 1, file) == 1;) {
+        if (header.size % 8 || (header.type == recordRow && header.size != header.count * sizeof(double)))
+            break;
+
+        payload.resize(header.size);
+        if (std::fread(payload.data(), 1, header.size, file) != header.size)
+            break;
+
+        if (header.type == recordColumns) {
+            Columns entry;
+            auto text{ payload.data() };
+            auto end{ payload.data() + payload.size() };
+
+            for (uint32_t i{ 0 }; i < header.count * 2 && text < end; i++) {
+                auto length{ strnlen(text, end - text) };
+                (i % 2 ? entry.aliases : entry.names).emplace_back(text, length);
+                text += length + 1;
+            }
+
+            if (entry.aliases.size() != header.count)
+                break;
+
+            columns[header.key] = std::move(entry);
+        } else if (header.type == recordRow) {
+            std::vector<double> row(header.count);
+            std::memcpy(row.data(), payload.data(), header.size);
+            rows[header.key] = std::move(row);
+        }
+
+        offset += sizeof(header) + header.size;
+    }
+
+    return offset;
+}
+
+bool ScoreCache::load() {
+    std::unique_ptr<FILE, decltype(&fclose)> file{ std::fopen(path.c_str(), "rb"), fclose };
+    if (!file)
+        return true;
+
+    char magic[8];
+    if (std::fread(magic, 1, sizeof(magic), file.get()) != sizeof(magic))
+        return std::ferror(file.get()) == 0 && std::feof(file.get()) && !std::ftell(file.get());
+    if (std::memcmp(magic, cacheMagic, sizeof(magic)))
+        return false;
+
+    validSize = scan(file.get(), sizeof(magic));
+    return true;
+}
+
+bool ScoreCache::save() {
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    if (newColumns.empty() && newRows.empty())
+        return true;
+
+    std::unique_ptr<FILE, decltype(&fclose)> file{ std::fopen(path.c_str(), "a+b"), fclose };
+    if (!file)
+        return false;
+
+    FileLock fileLock{ file.get() };
+    if (!fileLock.locked() || !seek(file.get(), 0, SEEK_END))
+        return false;
+
+    // Other runs may have appended to the file since it was loaded, or created it. Their records are read under the lock, and
+    // only what follows the last whole record, which a run that was interrupted may have left, is cut off.
+    auto size{ tell(file.get()) };
+    uint64_t end{};
+
+    if (size >= 8) {
+        char magic[8];
+        if (!seek(file.get(), 0) || std::fread(magic, 1, sizeof(magic), file.get()) != sizeof(magic) ||
+            std::memcmp(magic, cacheMagic, sizeof(magic)))
+            return false;
+
+        end = scan(file.get(), validSize >= sizeof(magic) && validSize <= size ? validSize : sizeof(magic));
+    }
+
+    if (end != size && !truncateFile(file.get(), end))
+        return false;
+
+    if (!seek(file.get(), 0, SEEK_END) || (!end && std::fwrite(cacheMagic, 1, 8, file.get()) != 8))
+        return false;
+
+    std::vector<char> payload;
+
+    for (auto&& key : newColumns) {
+        auto&& entry{ columns[key] };
+        payload.clear();
+
+        for (size_t i{ 0 }; i < entry.names.size(); i++)
+            for (auto&& text : { entry.names[i], entry.aliases[i] })
+                payload.insert(payload.end(), text.c_str(), text.c_str() + text.size() + 1);
+
+        payload.resize(padded(payload.size()));
+
+        RecordHeader header{ recordColumns, static_cast<uint32_t>(entry.names.size()), key, payload.size() };
+        if (std::fwrite(&header, sizeof(header), 1, file.get()) != 1 ||
+            std::fwrite(payload.data(), 1, payload.size(), file.get()) != payload.size())
+            return false;
+    }
+
+    for (auto&& key : newRows) {
+        auto&& row{ rows[key] };
+
+        RecordHeader header{ recordRow, static_cast<uint32_t>(row.size()), key, row.size() * sizeof(double) };
+        if (std::fwrite(&header, sizeof(header), 1, file.get()) != 1 ||
+            std::fwrite(row.data(), sizeof(double), row.size(), file.get()) != row.size())
+            return false;
+    }
+
+    if (std::fflush(file.get()))
+        return false;
+
+    newColumns.clear();
+    newRows.clear();
+    validSize = tell(file.get());
+    return true;
+}
+
+void ScoreCache::addColumns(uint64_t config, const std::vector<std::string>& names, const std::vector<std::string>& aliases) {
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    if (columns.emplace(config, Columns{ names, aliases }).second)
+        newColumns.push_back(config);
+}
+
+bool ScoreCache::find(uint64_t key, std::vector<double>* row) {
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    auto entry{ rows.find(key) };
+    if (entry == rows.end())
+        return false;
+
+    *row = entry->second;
+    return true;
+}
+
+void ScoreCache::insert(uint64_t key, const std::vector<double>& row) {
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    if (rows.emplace(key, row).second)
+        newRows.push_back(key);
+}
+
+uint64_t ScoreCache::hash(const std::string& text) noexcept {
+    uint64_t key{ 0xCBF29CE484222325 };
+
+    for (auto&& c : text) {
+        key ^= static_cast<unsigned char>(c);
+        key *= 0x100000001B3;
+    }
+
+    return key;
+}
+
+uint64_t ScoreCache::combine(uint64_t key, uint64_t value) noexcept {
+    key ^= value + 0x9E3779B97F4A7C15 + (key << 6) + (key >> 2);
+    key ^= key >> 31;
+    key *= 0xBF58476D1CE4E5B9;
+    key ^= key >> 29;
+    return key;
+}
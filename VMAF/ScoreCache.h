@@ -0,0 +1,90 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-frame scores of earlier runs, kept in a single append-only file so that rescoring a title only scores the frames whose
+// content changed. Rows are keyed by a hash of the frames they depend on and of the configuration that scored them, and the
+// columns of each configuration are stored once by its own key.
+//
+// The file starts with the 8 bytes "VMAFSC01" and is followed by records, all fields little-endian and 8-byte aligned:
+//
+//     uint32_t type;     1 = columns, 2 = row
+//     uint32_t count;    number of columns
+//     uint64_t key;      configuration key for columns, frame key for rows
+//     uint64_t size;     bytes of payload that follow, a multiple of 8
+//
+// The payload of columns is count pairs of NUL-terminated libvmaf name and log alias, zero-padded. That of a row is count doubles
+// in the order of its configuration's columns, a quiet NaN where the frame has no score. A record cut short by an interrupted
+// run is dropped, and so is everything after it.
+//
+// The records are laid out so that the file could be mapped, but load() reads them into hash maps instead, which appending runs
+// and rows of several configurations do not disturb.
+//
+// Several runs may share a file. save() holds an advisory lock on it while it reads the records other runs appended since load()
+// and appends its own after them, cutting off nothing but a record left incomplete by an interrupted run. Rows that other runs
+// append while this one is scoring are not looked up until the next run.
+class ScoreCache final {
+    struct Columns final {
+        std::vector<std::string> names;
+        std::vector<std::string> aliases;
+    };
+
+    std::string path;
+    std::mutex mutex;
+    uint64_t validSize{};
+    std::unordered_map<uint64_t, Columns> columns;
+    std::unordered_map<uint64_t, std::vector<double>> rows;
+    std::vector<uint64_t> newColumns;
+    std::vector<uint64_t> newRows;
+
+    // Reads the records from offset up to the first that is cut short, and returns the offset after the last whole one.
+    uint64_t scan(FILE* file, uint64_t offset);
+
+public:
+    explicit ScoreCache(std::string cachePath) : path{ std::move(cachePath) } {}
+
+    // Reads the file if there is one. Fails only when it exists and is not a cache.
+    bool load();
+
+    // Appends what was added since load() or the last save().
+    bool save();
+
+    void addColumns(uint64_t config, const std::vector<std::string>& names, const std::vector<std::string>& aliases);
+
+    bool find(uint64_t key, std::vector<double>* row);
+    void insert(uint64_t key, const std::vector<double>& row);
+
+    static uint64_t hash(const std::string& text) noexcept;
+
+    // Folds another value into a key, so that keys of the same values in another order differ.
+    static uint64_t combine(uint64_t key, uint64_t value) noexcept;
+};
@@ -0,0 +1,213 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    Layout of the binary score log written with log_format=4. It is self-contained C so that consumers can copy it as is and
+    read a log that has been mapped into memory without any parsing.
+
+    All fields are little-endian.
+
+        VmafScoreLogHeader                      at offset 0
+        VmafScoreLogColumn[numColumns]          right after the header
+        double[numColumns][numFrames]           at dataOffset, one contiguous column per metric in header order
+        VmafScoreLogAggregate[numAggregates]    at aggregateOffset
+        VmafScoreLogSegment[numSegments]        at segmentOffset
+        double[numSegments][numColumns][VMAF_SCORE_LOG_POOL_NB]  right after the segments
+
+    Row i of every column is frame firstFrame + i of the clip. width and height are those of the scored region, which the crop
+    fields place within the reference. dataOffset is a multiple of VMAF_SCORE_LOG_ALIGNMENT. Frames a metric has no score for hold
+    a quiet NaN, and so does a pooled value that libvmaf would not have reported because not every frame was scored. Segments are
+    only present when the clip was pooled per segment, and their frame numbers are those of the clip.
+*/
+
+#ifndef VMAF_SCORE_LOG_H
+#define VMAF_SCORE_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define VMAF_SCORE_LOG_MAGIC "VMAFSLOG"
+#define VMAF_SCORE_LOG_VERSION 4
+#define VMAF_SCORE_LOG_ALIGNMENT 64
+
+/* Set in flags when the crop was detected by autocrop rather than given. */
+#define VMAF_SCORE_LOG_CROP_DETECTED 1
+/* Set in flags when preview scored pictures downscaled by 2, so the scores are approximate. Width and height are those of the
+   scored pictures. */
+#define VMAF_SCORE_LOG_PREVIEW 2
+
+enum VmafScoreLogPool {
+    VMAF_SCORE_LOG_POOL_MIN,
+    VMAF_SCORE_LOG_POOL_MAX,
+    VMAF_SCORE_LOG_POOL_MEAN,
+    VMAF_SCORE_LOG_POOL_HARMONIC_MEAN,
+    VMAF_SCORE_LOG_POOL_NB
+};
+
+typedef struct VmafScoreLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numColumns;
+    uint64_t numFrames;
+    uint64_t dataOffset;
+    uint64_t aggregateOffset;
+    uint32_t numAggregates;
+    uint32_t width;
+    uint32_t height;
+    uint32_t cropLeft;
+    uint32_t cropRight;
+    uint32_t cropTop;
+    uint32_t cropBottom;
+    uint32_t flags;
+    uint32_t firstFrame;
+    uint32_t numSegments;
+    double fps;
+    uint64_t segmentOffset;
+} VmafScoreLogHeader;
+
+typedef struct VmafScoreLogColumn {
+    char name[64];
+    double pooled[VMAF_SCORE_LOG_POOL_NB];
+} VmafScoreLogColumn;
+
+typedef struct VmafScoreLogAggregate {
+    char name[56];
+    double value;
+} VmafScoreLogAggregate;
+
+typedef struct VmafScoreLogSegment {
+    uint32_t first;
+    uint32_t last;
+} VmafScoreLogSegment;
+
+/* The layout above is fixed: every field sits at its natural alignment with no gaps between fields or at the end of a struct,
+   so no compiler or ABI inserts padding. A field added later must keep it that way with explicit padding. Checked with C11 or
+   C++. */
+#ifdef __cplusplus
+#define VMAF_SCORE_LOG_ASSERT(condition) static_assert(condition, #condition)
+#else
+#define VMAF_SCORE_LOG_ASSERT(condition) _Static_assert(condition, #condition)
+#endif
+
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, magic) == 0);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, version) == 8);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, numColumns) == 12);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, numFrames) == 16);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, dataOffset) == 24);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, aggregateOffset) == 32);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, numAggregates) == 40);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, width) == 44);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, height) == 48);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, cropLeft) == 52);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, cropRight) == 56);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, cropTop) == 60);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, cropBottom) == 64);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, flags) == 68);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, firstFrame) == 72);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, numSegments) == 76);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, fps) == 80);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogHeader, segmentOffset) == 88);
+VMAF_SCORE_LOG_ASSERT(sizeof(VmafScoreLogHeader) == 96);
+
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogColumn, name) == 0);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogColumn, pooled) == 64);
+VMAF_SCORE_LOG_ASSERT(sizeof(VmafScoreLogColumn) == 96);
+
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogAggregate, name) == 0);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogAggregate, value) == 56);
+VMAF_SCORE_LOG_ASSERT(sizeof(VmafScoreLogAggregate) == 64);
+
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogSegment, first) == 0);
+VMAF_SCORE_LOG_ASSERT(offsetof(VmafScoreLogSegment, last) == 4);
+VMAF_SCORE_LOG_ASSERT(sizeof(VmafScoreLogSegment) == 8);
+
+VMAF_SCORE_LOG_ASSERT(sizeof(double) == 8);
+
+typedef struct VmafScoreLog {
+    const VmafScoreLogHeader* header;
+    const VmafScoreLogColumn* columns;
+    const VmafScoreLogAggregate* aggregates;
+    const double* data;
+    const VmafScoreLogSegment* segments;
+    const double* segmentPooled;
+} VmafScoreLog;
+
+/* Validates a log of size bytes at data, which must be aligned to 8 bytes, and points log into it. Returns 0 on success. */
+static inline int vmaf_score_log_parse(VmafScoreLog* log, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    const VmafScoreLogHeader* header = (const VmafScoreLogHeader*)data;
+    uint64_t columns;
+
+    if (size < sizeof(VmafScoreLogHeader) || memcmp(header->magic, VMAF_SCORE_LOG_MAGIC, 8) ||
+        header->version != VMAF_SCORE_LOG_VERSION)
+        return -1;
+
+    columns = header->numColumns;
+
+    if (sizeof(VmafScoreLogHeader) + columns * sizeof(VmafScoreLogColumn) > header->dataOffset ||
+        header->dataOffset % VMAF_SCORE_LOG_ALIGNMENT ||
+        header->dataOffset + columns * header->numFrames * sizeof(double) > header->aggregateOffset ||
+        header->aggregateOffset + (uint64_t)header->numAggregates * sizeof(VmafScoreLogAggregate) > size ||
+        (header->numSegments &&
+         (header->segmentOffset % sizeof(double) ||
+          header->segmentOffset +
+                  header->numSegments * (sizeof(VmafScoreLogSegment) + columns * VMAF_SCORE_LOG_POOL_NB * sizeof(double)) >
+              size)))
+        return -1;
+
+    log->header = header;
+    log->columns = (const VmafScoreLogColumn*)(bytes + sizeof(VmafScoreLogHeader));
+    log->aggregates = (const VmafScoreLogAggregate*)(bytes + header->aggregateOffset);
+    log->data = (const double*)(bytes + header->dataOffset);
+    log->segments = (const VmafScoreLogSegment*)(bytes + header->segmentOffset);
+    log->segmentPooled = (const double*)(bytes + header->segmentOffset + header->numSegments * sizeof(VmafScoreLogSegment));
+    return 0;
+}
+
+/* Per-frame scores of a column, numFrames of them. */
+static inline const double* vmaf_score_log_column(const VmafScoreLog* log, uint32_t column) {
+    return column < log->header->numColumns ? log->data + (uint64_t)column * log->header->numFrames : NULL;
+}
+
+/* Pooled scores of a column over one segment, VMAF_SCORE_LOG_POOL_NB of them. */
+static inline const double* vmaf_score_log_segment_pooled(const VmafScoreLog* log, uint32_t segment, uint32_t column) {
+    if (segment >= log->header->numSegments || column >= log->header->numColumns)
+        return NULL;
+
+    return log->segmentPooled + ((uint64_t)segment * log->header->numColumns + column) * VMAF_SCORE_LOG_POOL_NB;
+}
+
+/* Index of the column with the given name as it appears in the text logs, e.g. "vmaf" or "psnr_y", or -1. */
+static inline int vmaf_score_log_find(const VmafScoreLog* log, const char* name) {
+    uint32_t i;
+
+    for (i = 0; i < log->header->numColumns; i++)
+        if (!strncmp(log->columns[i].name, name, sizeof(log->columns[i].name)))
+            return (int)i;
+
+    return -1;
+}
+
+#endif
@@ -24,133 +24,2104 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <charconv>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <vector>
 
 #include <VapourSynth4.h>
 #include <VSHelper4.h>
 
+#include "CIEDE.h"
+#include "Crop.h"
+#include "Log.h"
+#include "PSNR.h"
+#include "PSNRHVS.h"
+#include "Resize.h"
+#include "Sampling.h"
+#include "SSIM.h"
+#include "SceneCut.h"
+#include "ScoreCache.h"
+
+#ifdef VMAF_PRIVATE_API
+#include "VmafPrivate.h"
+#endif
+
 extern "C" {
 #include <libvmaf.h>
 #include <libvmaf_cuda.h>
 }
 
-using namespace std::literals;
+using namespace std::literals;
+
+static constexpr const char* modelName[]{ "vmaf", "vmaf_neg", "vmaf_b", "vmaf_4k" };
+static constexpr const char* modelVersion[]{ "vmaf_v0.6.1", "vmaf_v0.6.1neg", "vmaf_b_v0.6.3", "vmaf_4k_v0.6.1" };
+
+static constexpr const char* featureName[]{ "psnr", "psnr_hvs", "float_ssim", "float_ms_ssim", "ciede" };
+
+static constexpr int pictureNumPlanes(VmafPixelFormat pixelFormat) noexcept {
+    return pixelFormat == VMAF_PIX_FMT_YUV400P ? 1 : 3;
+}
+
+struct PictureKey final {
+    VmafPixelFormat pixelFormat;
+    unsigned bitsPerSample;
+    unsigned width;
+    unsigned height;
+
+    bool operator==(const PictureKey& other) const noexcept {
+        return pixelFormat == other.pixelFormat && bitsPerSample == other.bitsPerSample && width == other.width &&
+               height == other.height;
+    }
+};
+
+// Row alignment libvmaf's SIMD extractors expect, matching what vmaf_picture_alloc guarantees.
+static constexpr uintptr_t pictureAlignment{ 32 };
+
+#ifdef VMAF_PRIVATE_API
+static bool attachRelease(VmafPicture* pic, void* cookie, int (*release)(VmafPicture* pic, void* cookie)) noexcept {
+    if (vmaf_picture_priv_init(pic))
+        return false;
+
+    if (vmaf_picture_set_release_callback(pic, cookie, release) || vmaf_ref_init(&pic->ref)) {
+        free(pic->priv);
+        pic->priv = nullptr;
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+// Picture buffers recycled through libvmaf's release path, where running dry allocates a fresh buffer rather than waiting.
+struct PicturePool final {
+    PictureKey key{};
+    size_t capacity{};
+    std::atomic<uint64_t> hits{};
+    std::atomic<uint64_t> misses{};
+    std::mutex mutex;
+    std::vector<void*> buffers;
+    std::array<unsigned, 3> width{};
+    std::array<unsigned, 3> height{};
+    std::array<ptrdiff_t, 3> stride{};
+    size_t size{};
+
+    PicturePool() = default;
+    PicturePool(const PicturePool&) = delete;
+    PicturePool& operator=(const PicturePool&) = delete;
+
+    ~PicturePool() {
+        for (auto&& buffer : buffers)
+            vsh::vsh_aligned_free(buffer);
+    }
+
+    void init(const PictureKey& poolKey, size_t poolCapacity, [[maybe_unused]] size_t prealloc) {
+        key = poolKey;
+        capacity = poolCapacity;
+
+        auto numPlanes{ pictureNumPlanes(key.pixelFormat) };
+        auto ssW{ key.pixelFormat == VMAF_PIX_FMT_YUV420P || key.pixelFormat == VMAF_PIX_FMT_YUV422P ? 1 : 0 };
+        auto ssH{ key.pixelFormat == VMAF_PIX_FMT_YUV420P ? 1 : 0 };
+
+        for (auto plane{ 0 }; plane < numPlanes; plane++) {
+            width[plane] = plane ? (key.width + ssW) >> ssW : key.width;
+            height[plane] = plane ? (key.height + ssH) >> ssH : key.height;
+            stride[plane] = (width[plane] * (key.bitsPerSample > 8 ? 2 : 1) + pictureAlignment - 1) & ~(pictureAlignment - 1);
+            size += stride[plane] * height[plane];
+        }
+
+#ifdef VMAF_PRIVATE_API
+        for (size_t i{ 0 }; i < std::min(prealloc, capacity); i++) {
+            auto buffer{ vsh::vsh_aligned_malloc(size, pictureAlignment) };
+            if (!buffer)
+                throw "failed to preallocate pictures"s;
+            buffers.push_back(buffer);
+        }
+#endif
+    }
+
+    int fetch(VmafPicture* pic, const PictureKey& picKey) noexcept {
+#ifdef VMAF_PRIVATE_API
+        if (picKey == key)
+            return fetchPooled(pic);
+#endif
+
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return vmaf_picture_alloc(pic, picKey.pixelFormat, picKey.bitsPerSample, picKey.width, picKey.height);
+    }
+
+#ifdef VMAF_PRIVATE_API
+    static int recycle(VmafPicture* pic, void* cookie) noexcept {
+        auto pool{ static_cast<PicturePool*>(cookie) };
+
+        {
+            std::lock_guard<std::mutex> lock{ pool->mutex };
+            if (pool->buffers.size() < pool->capacity) {
+                pool->buffers.push_back(pic->data[0]);
+                return 0;
+            }
+        }
+
+        vsh::vsh_aligned_free(pic->data[0]);
+        return 0;
+    }
+
+    int fetchPooled(VmafPicture* pic) noexcept {
+        void* buffer{};
+
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (!buffers.empty()) {
+                buffer = buffers.back();
+                buffers.pop_back();
+            }
+        }
+
+        if (buffer) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            if (!(buffer = vsh::vsh_aligned_malloc(size, pictureAlignment)))
+                return -1;
+        }
+
+        *pic = {};
+        pic->pix_fmt = key.pixelFormat;
+        pic->bpc = key.bitsPerSample;
+
+        auto data{ static_cast<uint8_t*>(buffer) };
+        for (auto plane{ 0 }; plane < 3 && height[plane]; plane++) {
+            pic->w[plane] = width[plane];
+            pic->h[plane] = height[plane];
+            pic->stride[plane] = stride[plane];
+            pic->data[plane] = data;
+            data += stride[plane] * height[plane];
+        }
+
+        if (!attachRelease(pic, this, recycle)) {
+            recycle(pic, this);
+            *pic = {};
+            return -1;
+        }
+
+        return 0;
+    }
+#endif
+};
+
+// Hands pictures to libvmaf strictly in index order, holding frames that finish early in a bounded reorder buffer.
+struct Sequencer final {
+    VmafContext* vmaf{};
+    unsigned depth{};
+    unsigned window{};
+    unsigned next{};
+    unsigned index{};
+    unsigned last{};
+    const char* error{};
+    bool closing{};
+    bool flushed{};
+    bool fed{};
+    const std::vector<std::pair<std::string, double>>* perfect{};
+    std::map<unsigned, std::pair<VmafPicture, VmafPicture>> pending;
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::thread worker;
+
+    Sequencer() = default;
+    Sequencer(const Sequencer&) = delete;
+    Sequencer& operator=(const Sequencer&) = delete;
+
+    ~Sequencer() {
+        close();
+    }
+
+    void start(VmafContext* context, unsigned queueDepth, unsigned reorderWindow, unsigned first, unsigned final) {
+        vmaf = context;
+        depth = queueDepth;
+        window = reorderWindow;
+        next = first;
+        index = first;
+        last = final;
+
+        if (depth)
+            worker = std::thread{ &Sequencer::run, this };
+    }
+
+    // Whether a picture for frame n would still be read, so that callers can skip preparing one that would be discarded.
+    bool wants(unsigned n) noexcept {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return !error && n >= next && n <= last && !pending.count(n);
+    }
+
+    const char* failure() noexcept {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return error;
+    }
+
+    // Whether frame n has yet to be read, i.e. is still buffered behind a frame that has not been pushed.
+    bool waiting(unsigned n) noexcept {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return next <= n;
+    }
+
+    // Takes ownership of both pictures, even when it throws.
+    void push(unsigned n, VmafPicture* ref, VmafPicture* dist) {
+        std::unique_lock<std::mutex> lock{ mutex };
+
+        if (error || n < next || n > last || pending.count(n)) {
+            vmaf_picture_unref(ref);
+            vmaf_picture_unref(dist);
+
+            if (error)
+                throw error;
+            return;
+        }
+
+        if (n - next >= window) {
+            vmaf_picture_unref(ref);
+            vmaf_picture_unref(dist);
+            throw "frame is too far ahead of the next one to be scored, request frames in order or raise queue_depth";
+        }
+
+        pending.emplace(n, std::make_pair(*ref, *dist));
+        *ref = {};
+        *dist = {};
+
+        if (depth) {
+            queued.notify_one();
+            return;
+        }
+
+        while (!pending.empty() && pending.begin()->first == next) {
+            auto node{ pending.extract(pending.begin()) };
+
+            if (auto failure{ submit(node.key(), &node.mapped().first, &node.mapped().second) })
+                throw error = failure;
+
+            next++;
+        }
+    }
+
+    void skip(unsigned n) {
+        VmafPicture ref{};
+        VmafPicture dist{};
+        push(n, &ref, &dist);
+    }
+
+    const char* submit(unsigned n, VmafPicture* ref, VmafPicture* dist) noexcept {
+        if (!ref->data[0])
+            return n == last ? flush() : nullptr;
+
+        if (!dist->data[0]) {
+            vmaf_picture_unref(ref);
+
+            for (auto&& [name, score] : *perfect)
+                if (vmaf_import_feature_score(vmaf, name.c_str(), score, index))
+                    return "failed to import scores";
+
+            fed = true;
+            index++;
+            return n == last ? flush() : nullptr;
+        }
+
+        if (vmaf_read_pictures(vmaf, ref, dist, index++)) {
+            vmaf_picture_unref(ref);
+            vmaf_picture_unref(dist);
+            return "failed to read pictures";
+        }
+
+        fed = true;
+
+        if (n == last)
+            return flush();
+
+        return nullptr;
+    }
+
+    const char* flush() noexcept {
+        if (flushed)
+            return nullptr;
+
+        // A context that every frame was kept out of, e.g. because all of them were cached, has nothing to flush.
+        flushed = true;
+        if (!fed)
+            return nullptr;
+
+        return vmaf_read_pictures(vmaf, nullptr, nullptr, 0) ? "failed to flush context" : nullptr;
+    }
+
+    void run() noexcept {
+        std::unique_lock<std::mutex> lock{ mutex };
+
+        for (;;) {
+            queued.wait(lock, [&] { return closing || (!pending.empty() && pending.begin()->first == next); });
+
+            if (pending.empty() || pending.begin()->first != next)
+                break;
+
+            auto node{ pending.extract(pending.begin()) };
+            lock.unlock();
+
+            auto failure{ submit(node.key(), &node.mapped().first, &node.mapped().second) };
+
+            lock.lock();
+
+            if (failure) {
+                error = failure;
+                break;
+            }
+
+            next++;
+        }
+    }
+
+    // Drains whatever is contiguous and returns the number of frames that had to be dropped because an earlier one never arrived.
+    size_t close() noexcept {
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            closing = true;
+        }
+
+        queued.notify_one();
+        if (worker.joinable())
+            worker.join();
+
+        auto dropped{ pending.size() };
+        for (auto&& [n, pics] : pending) {
+            vmaf_picture_unref(&pics.first);
+            vmaf_picture_unref(&pics.second);
+        }
+        pending.clear();
+
+        return dropped;
+    }
+};
+
+// A context scoring one contiguous range of the clip, reading the frame on either side for the motion at its edges.
+struct Shard final {
+    unsigned first;
+    unsigned last;
+    unsigned feedFirst;
+    unsigned feedLast;
+    VmafContext* vmaf;
+    VmafCudaState* cuState;
+    Sequencer sequencer;
+};
+
+// Whether a frame is scored when subsampling. An anchor is only read for the motion of the scored frame after it.
+enum Sample : uint8_t {
+    sampleUndecided,
+    sampleScored,
+    sampleSkipped,
+    sampleAnchor
+};
+
+// Where the row of a frame comes from with cache_path.
+enum Cached : uint8_t {
+    cacheMiss,
+    cacheSkipped,
+    cacheRead
+};
+
+// Whether a sampling slot feeds its drawn frame or keeps its place empty, decided the first time its output frame is produced.
+enum Slot : uint8_t {
+    slotUndecided,
+    slotFed,
+    slotSkipped
+};
+
+// Where the collector is within a shard.
+struct Cursor final {
+    unsigned next;
+    unsigned index;
+    unsigned piece;
+    unsigned scoredFrame;
+    std::vector<double> scoredScore;
+    std::vector<bool> scoredWritten;
+};
+
+// A score every frame must have before it is final, also attached as a frame property with props.
+struct FrameScore final {
+    std::string key;
+    std::string name;
+    VmafModel* model;
+};
+
+// Estimated mean of the first score from a sample of the frames, with the half width of its confidence interval.
+struct SampleEstimate final {
+    double mean;
+    double halfWidth;
+    unsigned frames;
+};
+
+// One distorted clip with its own contexts and log, split into the same shards as every other.
+struct Rendition final {
+    VSNode* distorted;
+    std::vector<PlaneResizer> resizers;
+    std::string logPath;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::unique_ptr<LogWriter> writer;
+    std::vector<std::string> names;
+    std::vector<Cursor> cursors;
+    std::vector<double> score;
+    std::vector<bool> written;
+    std::unique_ptr<StratifiedSample> sample;
+    std::map<unsigned, std::pair<std::vector<double>, std::vector<bool>>> sampledRows;
+    SampleEstimate estimate;
+    std::atomic<unsigned> identical;
+    std::unique_ptr<std::atomic<uint64_t>[]> distortedHash;
+    std::unique_ptr<std::atomic<bool>[]> repeated;
+    std::atomic<unsigned> repeats;
+    uint64_t cacheConfig;
+    std::unique_ptr<std::atomic<uint64_t>[]> frameKey;
+    std::unique_ptr<std::atomic<uint8_t>[]> cached;
+    std::atomic<unsigned> cacheHits;
+    std::atomic<unsigned> cacheMisses;
+    std::mutex computedMutex;
+    std::map<unsigned, std::vector<double>> computed;
+};
+
+// Collects the rows of the logs in the background, and wakes the frames waiting in attachProps after every pass.
+struct Collector final {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable scored;
+    unsigned waiting;
+    bool closing;
+};
+
+struct VMAFData final {
+    std::string filterName;
+    VSNode* reference;
+    const VSVideoInfo* vi;
+    unsigned first;
+    unsigned numFrames;
+    int sceneDetect;
+    double sceneThreshold;
+    std::unique_ptr<std::atomic<bool>[]> cut;
+    bool sectioned;
+    int subsample;
+    bool subsampleIframes;
+    std::unique_ptr<std::atomic<uint8_t>[]> sampled;
+    double cascade;
+    std::unique_ptr<std::atomic<double>[]> screen;
+    bool native;
+    std::unique_ptr<CIEDE2000> ciede;
+    bool psnrHVS;
+    std::vector<std::pair<std::string, double>> perfectScores;
+    bool reuseRepeats;
+    std::unique_ptr<std::atomic<uint64_t>[]> referenceHash;
+    std::unique_ptr<ScoreCache> cache;
+    bool ssimMap;
+    VSVideoInfo mapInfo;
+    bool sampling;
+    double sampleMargin;
+    double sampleConfidence;
+    unsigned sampleStrata;
+    std::vector<unsigned> sampleOrder;
+    std::unique_ptr<std::atomic<uint8_t>[]> slot;
+    std::atomic<bool> sampleMet;
+    VmafOutputFormat logFormat;
+    std::vector<int> modelId;
+    std::vector<bool> collectionModel;
+    std::vector<VmafModel*> model;
+    std::vector<VmafModelCollection*> modelCollection;
+    std::vector<int> feature;
+    std::vector<std::unique_ptr<Rendition>> renditions;
+    std::vector<FrameScore> scores;
+    bool props;
+    int propLag;
+    double propTimeout;
+    VmafPixelFormat pixelFormat;
+    int cropLeft;
+    int cropRight;
+    int cropTop;
+    int cropBottom;
+    bool cropDetected;
+    int width;
+    int height;
+    bool preview;
+    int pictureWidth;
+    int pictureHeight;
+    PicturePool pool;
+    Collector collector;
+    std::chrono::steady_clock::time_point start;
+    bool chroma;
+    bool zeroCopy;
+    std::atomic<uint64_t> zeroCopyFrames;
+    std::atomic<uint64_t> zeroCopyFallbacks;
+};
+
+#ifdef VMAF_PRIVATE_API
+struct FrameCookie final {
+    const VSAPI* vsapi;
+    const VSFrame* frame;
+};
+
+static int releaseFrame([[maybe_unused]] VmafPicture* pic, void* cookie) noexcept {
+    auto c{ static_cast<FrameCookie*>(cookie) };
+    c->vsapi->freeFrame(c->frame);
+    delete c;
+    return 0;
+}
+#endif
+
+// Top-left sample of the region of interest in a plane of a frame of the reference's size.
+static const uint8_t* cropOrigin(const VSFrame* frame, int plane, const VMAFData* d, const VSAPI* vsapi) noexcept {
+    auto ssW{ plane ? d->vi->format.subSamplingW : 0 };
+    auto ssH{ plane ? d->vi->format.subSamplingH : 0 };
+
+    return vsapi->getReadPtr(frame, plane) + (d->cropTop >> ssH) * vsapi->getStride(frame, plane) +
+           (d->cropLeft >> ssW) * d->vi->format.bytesPerSample;
+}
+
+// Whether the region of interest of the distorted frame is bit-identical to the reference's in every plane the pictures carry.
+static bool identicalFrames(const VSFrame* reference, const VSFrame* distorted, const VMAFData* d, const VSAPI* vsapi) noexcept {
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+        auto ssW{ plane ? d->vi->format.subSamplingW : 0 };
+        auto ssH{ plane ? d->vi->format.subSamplingH : 0 };
+        auto a{ cropOrigin(reference, plane, d, vsapi) };
+        auto b{ cropOrigin(distorted, plane, d, vsapi) };
+        auto strideA{ vsapi->getStride(reference, plane) };
+        auto strideB{ vsapi->getStride(distorted, plane) };
+        auto rowSize{ static_cast<size_t>(d->width >> ssW) * d->vi->format.bytesPerSample };
+
+        for (auto y{ 0 }; y < d->height >> ssH; y++)
+            if (std::memcmp(a + y * strideA, b + y * strideB, rowSize))
+                return false;
+    }
+
+    return true;
+}
+
+// xxHash64-style fingerprint of the region of interest of a frame. Never 0, which marks a frame not hashed yet.
+static uint64_t fingerprintFrame(const VSFrame* frame, const VMAFData* d, const VSAPI* vsapi, bool scaled = false) noexcept {
+    constexpr uint64_t prime1{ 0x9E3779B185EBCA87 };
+    constexpr uint64_t prime2{ 0xC2B2AE3D27D4EB4F };
+    constexpr uint64_t prime3{ 0x165667B19E3779F9 };
+
+    auto rotate = [](uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    };
+
+    auto round = [&](uint64_t lane, uint64_t input) {
+        return rotate(lane + input * prime2, 31) * prime1;
+    };
+
+    uint64_t lanes[]{ prime1 + prime2, prime2, 0, 0 - prime1 };
+    uint64_t tail{ prime3 };
+
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+        auto ssW{ plane ? d->vi->format.subSamplingW : 0 };
+        auto ssH{ plane ? d->vi->format.subSamplingH : 0 };
+        auto row{ scaled ? vsapi->getReadPtr(frame, plane) : cropOrigin(frame, plane, d, vsapi) };
+        auto stride{ vsapi->getStride(frame, plane) };
+        auto width{ scaled ? vsapi->getFrameWidth(frame, plane) : d->width >> ssW };
+        auto height{ scaled ? vsapi->getFrameHeight(frame, plane) : d->height >> ssH };
+        auto rowSize{ static_cast<size_t>(width) * d->vi->format.bytesPerSample };
+
+        for (auto y{ 0 }; y < height; y++, row += stride) {
+            size_t x{ 0 };
+
+            for (; x + 32 <= rowSize; x += 32) {
+                for (auto l{ 0 }; l < 4; l++) {
+                    uint64_t word;
+                    std::memcpy(&word, row + x + l * 8, 8);
+                    lanes[l] = round(lanes[l], word);
+                }
+            }
+
+            for (; x < rowSize; x++)
+                tail = round(tail, row[x]);
+        }
+    }
+
+    auto hash{ rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18) };
+    hash = (hash ^ round(0, tail)) * prime1;
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+
+    return hash ? hash : 1;
+}
+
+// The score a metric gives a frame identical to the reference.
+static double perfectScore(const std::string& name, const VMAFData* d) noexcept {
+    if (name == "float_ssim" || name == "float_ms_ssim")
+        return 1.0;
+    if (name == "ciede2000")
+        return std::numeric_limits<double>::infinity();
+    return 6.0 * d->vi->format.bitsPerSample + 12.0;
+}
+
+#ifdef VMAF_PRIVATE_API
+static bool wrapFrame(VmafPicture* pic, const VSFrame* frame, const VMAFData* d, const VSAPI* vsapi) noexcept {
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++)
+        if (reinterpret_cast<uintptr_t>(cropOrigin(frame, plane, d, vsapi)) % pictureAlignment ||
+            static_cast<uintptr_t>(vsapi->getStride(frame, plane)) % pictureAlignment)
+            return false;
+
+    *pic = {};
+    pic->pix_fmt = d->pixelFormat;
+    pic->bpc = d->vi->format.bitsPerSample;
+
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+        pic->w[plane] = d->pool.width[plane];
+        pic->h[plane] = d->pool.height[plane];
+        pic->stride[plane] = vsapi->getStride(frame, plane);
+        pic->data[plane] = const_cast<uint8_t*>(cropOrigin(frame, plane, d, vsapi));
+    }
+
+    auto cookie{ new (std::nothrow) FrameCookie{ vsapi, frame } };
+
+    if (!cookie || !attachRelease(pic, cookie, releaseFrame)) {
+        delete cookie;
+        *pic = {};
+        return false;
+    }
+
+    vsapi->addFrameRef(frame);
+    return true;
+}
+#endif
+
+// Gives dst the pictures of src: another reference to them, or a copy where libvmaf's private symbols are not available.
+static void sharePicture(VmafPicture* dst, VmafPicture* src, [[maybe_unused]] VMAFData* d) {
+#ifdef VMAF_PRIVATE_API
+    vmaf_picture_ref(dst, src);
+#else
+    if (d->pool.fetch(dst, d->pool.key))
+        throw "failed to allocate picture";
+
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++)
+        vsh::bitblt(dst->data[plane], dst->stride[plane], src->data[plane], src->stride[plane],
+                    src->w[plane] * (src->bpc > 8 ? 2 : 1), src->h[plane]);
+#endif
+}
+
+// With preview the region of interest is downscaled by 2 on the way.
+static void copyFrame(VmafPicture* pic, const VSFrame* frame, VMAFData* d, const VSAPI* vsapi) {
+    if (d->pool.fetch(pic, d->pool.key))
+        throw "failed to allocate picture";
+
+    if (d->preview) {
+        for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++)
+            halvePlane(cropOrigin(frame, plane, d, vsapi), vsapi->getStride(frame, plane), pic->data[plane], pic->stride[plane],
+                       pic->w[plane], pic->h[plane], d->vi->format.bitsPerSample);
+        return;
+    }
+
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+        vsh::bitblt(pic->data[plane],
+                    pic->stride[plane],
+                    cropOrigin(frame, plane, d, vsapi),
+                    vsapi->getStride(frame, plane),
+                    pic->w[plane] * d->vi->format.bytesPerSample,
+                    pic->h[plane]);
+    }
+}
+
+// Resamples the region of interest of a distorted frame of another size straight into a picture of the reference's.
+static void scaleFrame(VmafPicture* pic, const VSFrame* frame, const std::vector<PlaneResizer>& resizers, VMAFData* d,
+                       const VSAPI* vsapi) {
+    if (d->pool.fetch(pic, d->pool.key))
+        throw "failed to allocate picture";
+
+    for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++)
+        resizers[plane].process(vsapi->getReadPtr(frame, plane), vsapi->getStride(frame, plane), pic->data[plane],
+                                pic->stride[plane], d->vi->format.bitsPerSample);
+}
+
+static void preparePicture(VmafPicture* pic, const VSFrame* frame, VMAFData* d, const VSAPI* vsapi,
+                           const std::vector<PlaneResizer>* resizers = nullptr) {
+    if (resizers && !resizers->empty()) {
+        scaleFrame(pic, frame, *resizers, d, vsapi);
+        return;
+    }
+
+#ifdef VMAF_PRIVATE_API
+    if (d->zeroCopy) {
+        if (wrapFrame(pic, frame, d, vsapi)) {
+            d->zeroCopyFrames.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        d->zeroCopyFallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+
+    copyFrame(pic, frame, d, vsapi);
+}
+
+// Marks frame n as the first of a shot when the reference says so or its luma jumps away from the previous frame's.
+static void detectCut(unsigned n, const VSFrame* reference, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (!n)
+        return;
+
+    if (d->sceneDetect == 1) {
+        int err;
+        if (vsapi->mapGetInt(vsapi->getFramePropertiesRO(reference), "_SceneChangePrev", 0, &err) && !err)
+            d->cut[n] = true;
+        return;
+    }
+
+    auto previous{ vsapi->getFrameFilter(d->first + n - 1, d->reference, frameCtx) };
+
+    if (lumaDifference(vsapi->getReadPtr(previous, 0), vsapi->getStride(previous, 0), vsapi->getReadPtr(reference, 0),
+                       vsapi->getStride(reference, 0), d->vi->width, d->vi->height,
+                       d->vi->format.bitsPerSample) > d->sceneThreshold)
+        d->cut[n] = true;
+
+    vsapi->freeFrame(previous);
+}
+
+// Luma PSNR of frame n against the reference, the lowest over all distorted clips. Each frame is screened once.
+static double screenFrame(unsigned n, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (auto psnr{ d->screen[n].load() }; !std::isnan(psnr))
+        return psnr;
+
+    auto reference{ vsapi->getFrameFilter(d->first + n, d->reference, frameCtx) };
+    auto psnr{ std::numeric_limits<double>::infinity() };
+
+    for (auto&& rendition : d->renditions) {
+        auto distorted{ vsapi->getFrameFilter(d->first + n, rendition->distorted, frameCtx) };
+
+        psnr = std::min(psnr, planePSNR(cropOrigin(reference, 0, d, vsapi), vsapi->getStride(reference, 0),
+                                        cropOrigin(distorted, 0, d, vsapi), vsapi->getStride(distorted, 0), d->width, d->height,
+                                        d->vi->format.bitsPerSample));
+        vsapi->freeFrame(distorted);
+    }
+
+    vsapi->freeFrame(reference);
+    d->screen[n] = psnr;
+    return psnr;
+}
+
+// Decides whether a frame left open by the subsampling stride is scored, by its picture type or the cascade's screen.
+static bool intraFrame(const VSFrame* frame, const VSAPI* vsapi) noexcept {
+    int err;
+    auto type{ vsapi->mapGetData(vsapi->getFramePropertiesRO(frame), "_PictType", 0, &err) };
+    return !err && type[0] == 'I';
+}
+
+static bool scoresFrame(unsigned n, const VSFrame* reference, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (d->subsampleIframes && intraFrame(reference, vsapi))
+        return true;
+
+    if (d->cascade <= 0.0)
+        return false;
+
+    auto following{ std::min(n + 1, d->numFrames - 1) };
+
+    if (d->sceneDetect && following != n) {
+        auto next{ vsapi->getFrameFilter(d->first + following, d->reference, frameCtx) };
+        detectCut(following, next, d, frameCtx, vsapi);
+        vsapi->freeFrame(next);
+    }
+
+    if (d->cut[n] || d->cut[following])
+        return true;
+
+    for (auto m{ n ? n - 1 : n }; m <= following; m++)
+        if (screenFrame(m, d, frameCtx, vsapi) < d->cascade)
+            return true;
+
+    return false;
+}
+
+// Whether frame n, which is not scored, is read as the anchor of a scored frame after it.
+static bool anchorsFrame(unsigned n, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (d->model.empty() || n + 1 >= d->numFrames)
+        return false;
+
+    if (d->sampled[n + 1] == sampleScored)
+        return true;
+
+    if (!d->subsampleIframes)
+        return false;
+
+    auto following{ vsapi->getFrameFilter(d->first + n + 1, d->reference, frameCtx) };
+    auto intra{ intraFrame(following, vsapi) };
+    vsapi->freeFrame(following);
+    return intra;
+}
+
+// Whether frame n repeats the pictures of the two frames before it, so that it reuses the scores of the frame before it.
+static bool repeatsPair(unsigned n, const Shard* shard, const Rendition* rendition, const VMAFData* d) noexcept {
+    if (n < shard->feedFirst + 2)
+        return false;
+
+    auto same = [&](unsigned m) {
+        return d->referenceHash[m] == d->referenceHash[n] && rendition->distortedHash[m] == rendition->distortedHash[n];
+    };
+
+    return same(n - 1) && same(n - 2);
+}
+
+// Fingerprints of frame m of the reference and of a distorted clip, hashed the first time they are needed.
+static uint64_t referenceFingerprint(unsigned m, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (auto hash{ d->referenceHash[m].load() })
+        return hash;
+
+    auto frame{ vsapi->getFrameFilter(d->first + m, d->reference, frameCtx) };
+    auto hash{ fingerprintFrame(frame, d, vsapi) };
+    vsapi->freeFrame(frame);
+
+    return d->referenceHash[m] = hash;
+}
+
+static uint64_t distortedFingerprint(unsigned m, Rendition* rendition, VMAFData* d, VSFrameContext* frameCtx,
+                                     const VSAPI* vsapi) {
+    if (auto hash{ rendition->distortedHash[m].load() })
+        return hash;
+
+    auto frame{ vsapi->getFrameFilter(d->first + m, rendition->distorted, frameCtx) };
+    auto hash{ fingerprintFrame(frame, d, vsapi, !rendition->resizers.empty()) };
+    vsapi->freeFrame(frame);
+
+    return rendition->distortedHash[m] = hash;
+}
+
+// Cache key of frame m of a distorted clip, memoized as the neighbours of every frame look it up again.
+static uint64_t frameKey(unsigned m, Rendition* rendition, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    if (auto key{ rendition->frameKey[m].load() })
+        return key;
+
+    auto key{ ScoreCache::combine(rendition->cacheConfig, distortedFingerprint(m, rendition, d, frameCtx, vsapi)) };
+    auto reach{ d->model.empty() ? 0 : 1 };
+
+    for (auto offset{ -reach }; offset <= reach; offset++) {
+        auto k{ static_cast<int64_t>(m) + offset };
+        auto fingerprint{ k < 0 || k >= d->numFrames ? 0 : referenceFingerprint(static_cast<unsigned>(k), d, frameCtx, vsapi) };
+        key = ScoreCache::combine(key, fingerprint);
+    }
+
+    return rendition->frameKey[m] = key ? key : 1;
+}
+
+// Feeds frame n to the given shard of every rendition that still wants it.
+static void feedShards(size_t index, unsigned n, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    std::vector<Rendition*> wanting;
+
+    for (auto&& rendition : d->renditions)
+        if (rendition->shards[index]->sequencer.wants(n))
+            wanting.push_back(rendition.get());
+
+    if (wanting.empty())
+        return;
+
+    auto reference{ vsapi->getFrameFilter(d->first + n, d->reference, frameCtx) };
+    const VSFrame* distorted{};
+
+    if (d->sceneDetect)
+        detectCut(n, reference, d, frameCtx, vsapi);
+
+    if (d->sampled[n] == sampleUndecided) {
+        try {
+            d->sampled[n] = scoresFrame(n, reference, d, frameCtx, vsapi) ? sampleScored
+                            : anchorsFrame(n, d, frameCtx, vsapi) ? sampleAnchor : sampleSkipped;
+        } catch (const char*) {
+            vsapi->freeFrame(reference);
+            throw;
+        }
+    }
+
+    if (d->sampled[n] == sampleSkipped) {
+        try {
+            for (auto&& rendition : wanting)
+                rendition->shards[index]->sequencer.skip(n);
+        } catch (const char*) {
+            vsapi->freeFrame(reference);
+            throw;
+        }
+
+        vsapi->freeFrame(reference);
+        return;
+    }
+
+    // Repeats are kept out of the context like skipped frames, and the collector copies the row of the frame before them.
+    if (d->reuseRepeats) {
+        d->referenceHash[n] = fingerprintFrame(reference, d, vsapi);
+
+        try {
+            wanting.erase(std::remove_if(wanting.begin(), wanting.end(),
+                                         [&](Rendition* rendition) {
+                                             auto shard{ rendition->shards[index].get() };
+                                             distorted = vsapi->getFrameFilter(d->first + n, rendition->distorted, frameCtx);
+                                             rendition->distortedHash[n] =
+                                                 fingerprintFrame(distorted, d, vsapi, !rendition->resizers.empty());
+                                             vsapi->freeFrame(distorted);
+                                             distorted = nullptr;
+
+                                             if (!repeatsPair(n, shard, rendition, d))
+                                                 return false;
+
+                                             rendition->repeated[n] = true;
+                                             if (n >= shard->first && n <= shard->last)
+                                                 rendition->repeats.fetch_add(1, std::memory_order_relaxed);
+
+                                             shard->sequencer.skip(n);
+                                             return true;
+                                         }),
+                          wanting.end());
+        } catch (const char*) {
+            vsapi->freeFrame(reference);
+            throw;
+        }
+
+        if (wanting.empty()) {
+            vsapi->freeFrame(reference);
+            return;
+        }
+    }
+
+    // A frame whose scores are cached is kept out of the context, unless a scored neighbour needs it for its motion.
+    if (d->cache) {
+        try {
+            wanting.erase(std::remove_if(wanting.begin(), wanting.end(),
+                                         [&](Rendition* rendition) {
+                                             auto shard{ rendition->shards[index].get() };
+                                             auto owned{ n >= shard->first && n <= shard->last };
+                                             std::vector<double> row;
+
+                                             // The frame before the range is always read.
+                                             if (n < shard->first)
+                                                 return false;
+
+                                             auto key{ frameKey(n, rendition, d, frameCtx, vsapi) };
+
+                                             auto hit{ d->cache->find(key, &row) };
+                                             if (owned)
+                                                 (hit ? rendition->cacheHits : rendition->cacheMisses)
+                                                     .fetch_add(1, std::memory_order_relaxed);
+
+                                             if (!hit)
+                                                 return false;
+
+                                             auto scored = [&](unsigned m) {
+                                                 return m < d->numFrames &&
+                                                        !d->cache->find(frameKey(m, rendition, d, frameCtx, vsapi), &row);
+                                             };
+
+                                             if (!d->model.empty() && ((n && scored(n - 1)) || scored(n + 1))) {
+                                                 if (owned)
+                                                     rendition->cached[n] = cacheRead;
+                                                 return false;
+                                             }
+
+                                             if (owned)
+                                                 rendition->cached[n] = cacheSkipped;
+
+                                             shard->sequencer.skip(n);
+                                             return true;
+                                         }),
+                          wanting.end());
+        } catch (const char*) {
+            vsapi->freeFrame(reference);
+            throw;
+        }
+
+        if (wanting.empty()) {
+            vsapi->freeFrame(reference);
+            return;
+        }
+    }
+
+    VmafPicture ref{};
+    VmafPicture refShare{};
+    VmafPicture dist{};
+
+    try {
+        preparePicture(&ref, reference, d, vsapi);
+
+        for (auto&& rendition : wanting) {
+            auto shard{ rendition->shards[index].get() };
+            distorted = vsapi->getFrameFilter(d->first + n, rendition->distorted, frameCtx);
+
+            // An identical frame shares the reference's picture or has its scores imported.
+            auto identical{ rendition->resizers.empty() && identicalFrames(reference, distorted, d, vsapi) };
+
+            if (identical && n >= shard->first && n <= shard->last)
+                rendition->identical.fetch_add(1, std::memory_order_relaxed);
+
+            if (!identical)
+                preparePicture(&dist, distorted, d, vsapi, &rendition->resizers);
+            else if (d->perfectScores.empty())
+                sharePicture(&dist, &ref, d);
+
+            sharePicture(&refShare, &ref, d);
+            shard->sequencer.push(n, &refShare, &dist);
+
+            vsapi->freeFrame(distorted);
+            distorted = nullptr;
+        }
+    } catch (const char*) {
+        vsapi->freeFrame(reference);
+        vsapi->freeFrame(distorted);
+
+        vmaf_picture_unref(&ref);
+        vmaf_picture_unref(&refShare);
+        vmaf_picture_unref(&dist);
+
+        throw;
+    }
+
+    vsapi->freeFrame(reference);
+    vmaf_picture_unref(&ref);
+}
+
+static size_t owningShard(const VMAFData* d, unsigned n) noexcept {
+    auto&& shards{ d->renditions.front()->shards };
+    auto owner{ std::find_if(shards.cbegin(), shards.cend(), [&](auto&& s) { return n >= s->first && n <= s->last; }) };
+    return owner - shards.cbegin();
+}
+
+static bool scoresAt(const VMAFData* d, const Shard* shard, unsigned n, double* values) noexcept {
+    for (auto&& score : d->scores) {
+        if (score.model ? vmaf_score_at_index(shard->vmaf, score.model, values, n)
+                        : vmaf_feature_score_at_index(shard->vmaf, score.name.c_str(), values, n))
+            return false;
+        values++;
+    }
+
+    return true;
+}
+
+// Each property holds one score per distorted clip, in the order they were given.
+static void setScoreProps(VSFrame* frame, const std::vector<double>& values, const VMAFData* d, const VSAPI* vsapi) {
+    auto props{ vsapi->getFramePropertiesRW(frame) };
+
+    for (size_t i{ 0 }; i < d->scores.size(); i++)
+        for (size_t r{ 0 }; r < d->renditions.size(); r++)
+            vsapi->mapSetFloat(props, d->scores[i].key.c_str(), values[r * d->scores.size() + i], r ? maAppend : maReplace);
+}
+
+// A native score of one distorted frame, read straight from the planes.
+static double measureScore(const FrameScore& score, const VSFrame* reference, const VSFrame* distorted, const double* hvs,
+                           const VMAFData* d, const VSAPI* vsapi) {
+    auto plane = [&](const VSFrame* frame, int p) {
+        return cropOrigin(frame, p, d, vsapi);
+    };
+
+    if (score.name == "psnr_hvs")
+        return hvsScore(0.8 * hvs[0] + 0.1 * (hvs[1] + hvs[2]), d->vi->format.bitsPerSample);
+
+    if (score.name.compare(0, 9, "psnr_hvs_") == 0)
+        return hvsScore(hvs[score.name == "psnr_hvs_cb" ? 1 : score.name == "psnr_hvs_cr" ? 2 : 0], d->vi->format.bitsPerSample);
+
+    if (score.name == "float_ssim")
+        return planeSSIM(plane(reference, 0), vsapi->getStride(reference, 0), plane(distorted, 0), vsapi->getStride(distorted, 0),
+                         d->width, d->height, d->vi->format.bitsPerSample);
+
+    if (score.name == "float_ms_ssim")
+        return planeMSSSIM(plane(reference, 0), vsapi->getStride(reference, 0), plane(distorted, 0),
+                           vsapi->getStride(distorted, 0), d->width, d->height, d->vi->format.bitsPerSample);
+
+    if (score.name == "ciede2000") {
+        const void* referencePlanes[]{ plane(reference, 0), plane(reference, 1), plane(reference, 2) };
+        const void* distortedPlanes[]{ plane(distorted, 0), plane(distorted, 1), plane(distorted, 2) };
+        ptrdiff_t referenceStride[]{ vsapi->getStride(reference, 0), vsapi->getStride(reference, 1),
+                                     vsapi->getStride(reference, 2) };
+        ptrdiff_t distortedStride[]{ vsapi->getStride(distorted, 0), vsapi->getStride(distorted, 1),
+                                     vsapi->getStride(distorted, 2) };
+
+        return d->ciede->score(referencePlanes, referenceStride, distortedPlanes, distortedStride, d->width, d->height,
+                               d->vi->format.subSamplingW, d->vi->format.subSamplingH);
+    }
+
+    auto p{ score.name == "psnr_cb" ? 1 : score.name == "psnr_cr" ? 2 : 0 };
+    auto ssW{ p ? d->vi->format.subSamplingW : 0 };
+    auto ssH{ p ? d->vi->format.subSamplingH : 0 };
+
+    return planePSNR(plane(reference, p), vsapi->getStride(reference, p), plane(distorted, p), vsapi->getStride(distorted, p),
+                     d->width >> ssW, d->height >> ssH, d->vi->format.bitsPerSample);
+}
+
+// Every native score of frame n of each distorted clip, writing the SSIM map of the first one to map if given.
+static std::vector<double> measureFrame(unsigned n, const VSFrame* reference, VMAFData* d, VSFrameContext* frameCtx,
+                                        const VSAPI* vsapi, float* map = nullptr, ptrdiff_t mapStride = 0) {
+    std::vector<double> values(d->scores.size() * d->renditions.size());
+    std::vector<uint64_t> missed(d->renditions.size());
+
+    for (size_t r{ 0 }; r < d->renditions.size(); r++) {
+        auto distorted{ vsapi->getFrameFilter(d->first + n, d->renditions[r]->distorted, frameCtx) };
+        auto mapped{ std::numeric_limits<double>::quiet_NaN() };
+        double hvs[3]{};
+
+        if (d->cache) {
+            auto&& rendition{ d->renditions[r] };
+            std::vector<double> row;
+            auto key{ frameKey(n, rendition.get(), d, frameCtx, vsapi) };
+
+            if (d->cache->find(key, &row) && row.size() == d->scores.size()) {
+                rendition->cacheHits.fetch_add(1, std::memory_order_relaxed);
+                std::copy(row.cbegin(), row.cend(), values.begin() + r * d->scores.size());
+                vsapi->freeFrame(distorted);
+                continue;
+            }
+
+            rendition->cacheMisses.fetch_add(1, std::memory_order_relaxed);
+            missed[r] = key;
+        }
+
+        if (identicalFrames(reference, distorted, d, vsapi)) {
+            d->renditions[r]->identical.fetch_add(1, std::memory_order_relaxed);
+
+            for (size_t i{ 0 }; i < d->scores.size(); i++)
+                values[r * d->scores.size() + i] = perfectScore(d->scores[i].name, d);
+
+            for (auto y{ 0 }; map && !r && y < d->mapInfo.height; y++)
+                std::fill_n(reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(map) + y * mapStride), d->mapInfo.width, 1.0f);
+
+            vsapi->freeFrame(distorted);
+            continue;
+        }
+
+        if (d->psnrHVS) {
+            for (int p{ 0 }; p < 3; p++) {
+                auto ssW{ p ? d->vi->format.subSamplingW : 0 };
+                auto ssH{ p ? d->vi->format.subSamplingH : 0 };
+                hvs[p] = planeHVSError(cropOrigin(reference, p, d, vsapi), vsapi->getStride(reference, p),
+                                       cropOrigin(distorted, p, d, vsapi), vsapi->getStride(distorted, p), d->width >> ssW,
+                                       d->height >> ssH, d->vi->format.bitsPerSample, p);
+            }
+        }
+
+        if (map && !r)
+            mapped = planeSSIM(cropOrigin(reference, 0, d, vsapi), vsapi->getStride(reference, 0),
+                               cropOrigin(distorted, 0, d, vsapi), vsapi->getStride(distorted, 0), d->width, d->height,
+                               d->vi->format.bitsPerSample, map, mapStride);
+
+        for (size_t i{ 0 }; i < d->scores.size(); i++)
+            values[r * d->scores.size() + i] = map && !r && d->scores[i].name == "float_ssim"
+                                                   ? mapped
+                                                   : measureScore(d->scores[i], reference, distorted, hvs, d, vsapi);
+
+        vsapi->freeFrame(distorted);
+    }
+
+    for (size_t r{ 0 }; r < d->renditions.size(); r++) {
+        auto&& rendition{ d->renditions[r] };
+        std::vector<double> row(values.cbegin() + r * d->scores.size(), values.cbegin() + (r + 1) * d->scores.size());
+
+        if (missed[r])
+            d->cache->insert(missed[r], row);
+
+        std::lock_guard<std::mutex> lock{ rendition->computedMutex };
+        rendition->computed.emplace(n, std::move(row));
+    }
+
+    return values;
+}
+
+// The SSIM map of a frame's luma against the first distorted clip, where the native path does not write it.
+static void computeMap(int n, VSFrame* map, const VSFrame* reference, const VMAFData* d, VSFrameContext* frameCtx,
+                       const VSAPI* vsapi) {
+    auto distorted{ vsapi->getFrameFilter(n, d->renditions.front()->distorted, frameCtx) };
+
+    planeSSIM(cropOrigin(reference, 0, d, vsapi), vsapi->getStride(reference, 0), cropOrigin(distorted, 0, d, vsapi),
+              vsapi->getStride(distorted, 0), d->width, d->height, d->vi->format.bitsPerSample,
+              reinterpret_cast<float*>(vsapi->getWritePtr(map, 0)), vsapi->getStride(map, 0));
+    vsapi->freeFrame(distorted);
+}
+
+// Waits for every score of frame n, woken by the collector after each of its passes.
+static void attachProps(VSFrame* frame, unsigned n, VMAFData* d, const VSAPI* vsapi) {
+    auto index{ owningShard(d, n) };
+    auto&& c{ d->collector };
+    std::vector<double> values(d->scores.size() * d->renditions.size());
+    const char* error{};
+
+    auto ready = [&] {
+        for (size_t r{ 0 }; r < d->renditions.size(); r++) {
+            auto shard{ d->renditions[r]->shards[index].get() };
+
+            if (!scoresAt(d, shard, n, values.data() + r * d->scores.size())) {
+                if (!(error = shard->sequencer.failure()) && !shard->sequencer.depth &&
+                    shard->sequencer.waiting(std::min(n + d->propLag, shard->feedLast)))
+                    error = "frames must be requested in order";
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (auto complete{ ready() }; !complete && !error) {
+        std::unique_lock<std::mutex> lock{ c.mutex };
+        c.waiting++;
+        c.wake.notify_one();
+
+        auto done = [&] { return (complete = ready()) || error || c.closing; };
+
+        if (d->propTimeout <= 0.0)
+            c.scored.wait(lock, done);
+        else if (!c.scored.wait_for(lock, std::chrono::duration<double>{ d->propTimeout }, done))
+            error = "timed out after prop_timeout seconds waiting for scores, frames must be requested in order";
+
+        c.waiting--;
+
+        if (!complete && !error)
+            error = "the filter was freed while waiting for scores";
+    }
+
+    if (error)
+        throw error;
+
+    setScoreProps(frame, values, d, vsapi);
+}
+
+// With sampling, every frame carries the current estimate of each distorted clip, NaN until there is one.
+static void attachEstimate(VSFrame* frame, VMAFData* d, const VSAPI* vsapi) {
+    auto props{ vsapi->getFramePropertiesRW(frame) };
+    auto&& key{ d->scores.front().key };
+    std::lock_guard<std::mutex> lock{ d->collector.mutex };
+
+    for (size_t r{ 0 }; r < d->renditions.size(); r++) {
+        auto&& estimate{ d->renditions[r]->estimate };
+        auto mode{ r ? maAppend : maReplace };
+
+        vsapi->mapSetFloat(props, (key + "_SampleMean").c_str(), estimate.mean, mode);
+        vsapi->mapSetFloat(props, (key + "_SampleCILow").c_str(), estimate.mean - estimate.halfWidth, mode);
+        vsapi->mapSetFloat(props, (key + "_SampleCIHigh").c_str(), estimate.mean + estimate.halfWidth, mode);
+        vsapi->mapSetInt(props, (key + "_SampleFrames").c_str(), estimate.frames, mode);
+    }
+}
+
+// The frames fed for drawn frame k, or -1 where the position is left empty.
+static std::array<int, 3> slotFrames(const VMAFData* d, unsigned k) noexcept {
+    auto last{ d->numFrames - 1 };
+    return { k ? static_cast<int>(k - 1) : k != last ? 0 : -1, static_cast<int>(k), k != last ? static_cast<int>(k + 1) : -1 };
+}
+
+// Output frame n feeds slot n of the drawn order to shard n % shards, three sequencer positions per slot.
+static void feedSlot(unsigned s, VMAFData* d, VSFrameContext* frameCtx, const VSAPI* vsapi) {
+    auto numShards{ d->renditions.front()->shards.size() };
+    auto index{ s % numShards };
+    auto base{ static_cast<unsigned>(s / numShards * 3) };
+    auto frames{ slotFrames(d, d->sampleOrder[s]) };
+
+    auto state{ static_cast<uint8_t>(slotUndecided) };
+    d->slot[s].compare_exchange_strong(state, d->sampleMet ? slotSkipped : slotFed);
+    auto fed{ d->slot[s] == slotFed };
+
+    for (unsigned i{ 0 }; i < frames.size(); i++) {
+        if (!fed || frames[i] < 0) {
+            for (auto&& rendition : d->renditions)
+                rendition->shards[index]->sequencer.skip(base + i);
+            continue;
+        }
+
+        if (std::none_of(d->renditions.cbegin(), d->renditions.cend(),
+                         [&](auto&& rendition) { return rendition->shards[index]->sequencer.wants(base + i); }))
+            continue;
+
+        auto reference{ vsapi->getFrameFilter(d->first + frames[i], d->reference, frameCtx) };
+        const VSFrame* distorted{};
+        VmafPicture ref{};
+        VmafPicture refShare{};
+        VmafPicture dist{};
+
+        try {
+            preparePicture(&ref, reference, d, vsapi);
+
+            for (auto&& rendition : d->renditions) {
+                distorted = vsapi->getFrameFilter(d->first + frames[i], rendition->distorted, frameCtx);
+                preparePicture(&dist, distorted, d, vsapi, &rendition->resizers);
+                sharePicture(&refShare, &ref, d);
+                rendition->shards[index]->sequencer.push(base + i, &refShare, &dist);
+
+                vsapi->freeFrame(distorted);
+                distorted = nullptr;
+            }
+        } catch (const char*) {
+            vsapi->freeFrame(reference);
+            vsapi->freeFrame(distorted);
+
+            vmaf_picture_unref(&ref);
+            vmaf_picture_unref(&refShare);
+            vmaf_picture_unref(&dist);
+
+            throw;
+        }
+
+        vsapi->freeFrame(reference);
+        vmaf_picture_unref(&ref);
+    }
+}
+
+// Output frame n feeds the n-th frame of every shard's range, and with props the prop_lag frames after it.
+static const VSFrame* VS_CC vmafGetFrame(int n, int activationReason, void* instanceData, [[maybe_unused]] void** frameData,
+                                         VSFrameContext* frameCtx, VSCore* core, const VSAPI* vsapi) {
+    auto d{ static_cast<VMAFData*>(instanceData) };
+    auto evaluated{ static_cast<unsigned>(n) >= d->first && static_cast<unsigned>(n) - d->first < d->numFrames };
+    auto current{ static_cast<unsigned>(n) - d->first };
+
+    if (activationReason == arInitial) {
+        vsapi->requestFrameFilter(n, d->reference, frameCtx);
+
+        if (d->ssimMap)
+            vsapi->requestFrameFilter(n, d->renditions.front()->distorted, frameCtx);
+
+        if (!evaluated)
+            return nullptr;
+
+        if (d->sampling) {
+            if (auto slot{ d->slot[current].load() }; slot == slotFed || (slot == slotUndecided && !d->sampleMet)) {
+                for (auto&& frame : slotFrames(d, d->sampleOrder[current])) {
+                    if (frame < 0)
+                        continue;
+                    vsapi->requestFrameFilter(d->first + frame, d->reference, frameCtx);
+                    for (auto&& rendition : d->renditions)
+                        vsapi->requestFrameFilter(d->first + frame, rendition->distorted, frameCtx);
+                }
+            }
+            return nullptr;
+        }
+
+        if (d->native) {
+            if (d->sceneDetect == 2 && current)
+                vsapi->requestFrameFilter(n - 1, d->reference, frameCtx);
+            for (auto&& rendition : d->renditions)
+                vsapi->requestFrameFilter(n, rendition->distorted, frameCtx);
+            return nullptr;
+        }
+
+        for (auto position{ current }; position <= current + d->propLag; position++) {
+            for (auto&& shard : d->renditions.front()->shards) {
+                if (auto frame{ shard->feedFirst + position }; frame <= shard->feedLast) {
+                    if (frame != current)
+                        vsapi->requestFrameFilter(d->first + frame, d->reference, frameCtx);
+                    if (d->sceneDetect == 2 && frame)
+                        vsapi->requestFrameFilter(d->first + frame - 1, d->reference, frameCtx);
+                    if (d->sampled[frame] != sampleSkipped)
+                        for (auto&& rendition : d->renditions)
+                            vsapi->requestFrameFilter(d->first + frame, rendition->distorted, frameCtx);
+
+                    // Whether an undecided frame is an anchor depends on the picture type of the next one.
+                    if (d->subsampleIframes && d->sampled[frame] == sampleUndecided && frame + 1 < d->numFrames)
+                        vsapi->requestFrameFilter(d->first + frame + 1, d->reference, frameCtx);
+
+                    // With a model the cache keys of a frame and of its neighbours reach two frames to either side.
+                    if (d->cache && !d->model.empty()) {
+                        for (auto m{ frame >= 2 ? frame - 2 : 0 }; m <= std::min(frame + 2, d->numFrames - 1); m++) {
+                            vsapi->requestFrameFilter(d->first + m, d->reference, frameCtx);
+                            if (m + 1 >= frame && m <= frame + 1)
+                                for (auto&& rendition : d->renditions)
+                                    vsapi->requestFrameFilter(d->first + m, rendition->distorted, frameCtx);
+                        }
+                    }
+
+                    // The screen looks at the frames on either side as well.
+                    if (d->cascade > 0.0 && d->sampled[frame] == sampleUndecided) {
+                        for (auto m{ frame ? frame - 1 : frame }; m <= std::min(frame + 1, d->numFrames - 1); m++) {
+                            vsapi->requestFrameFilter(d->first + m, d->reference, frameCtx);
+                            for (auto&& rendition : d->renditions)
+                                vsapi->requestFrameFilter(d->first + m, rendition->distorted, frameCtx);
+                        }
+                    }
+                }
+            }
+        }
+    } else if (activationReason == arAllFramesReady) {
+        auto reference{ vsapi->getFrameFilter(n, d->reference, frameCtx) };
+        VSFrame* map{};
+
+        if (d->ssimMap) {
+            map = vsapi->newVideoFrame(&d->mapInfo.format, d->mapInfo.width, d->mapInfo.height, reference, core);
+            if (!evaluated || !d->native)
+                computeMap(n, map, reference, d, frameCtx, vsapi);
+        }
+
+        auto output = [&](const VSFrame* frame) -> const VSFrame* {
+            if (!map)
+                return frame;
+
+            auto dst{ vsapi->copyFrame(frame, core) };
+            vsapi->freeFrame(frame);
+            vsapi->mapConsumeFrame(vsapi->getFramePropertiesRW(dst), "_SSIMMap", map, maReplace);
+            return dst;
+        };
+
+        if (!evaluated)
+            return output(reference);
+
+        if (d->sampling) {
+            try {
+                feedSlot(current, d, frameCtx, vsapi);
+            } catch (const char* error) {
+                vsapi->setFilterError((d->filterName + ": " + error).c_str(), frameCtx);
+                vsapi->freeFrame(reference);
+                vsapi->freeFrame(map);
+                return nullptr;
+            }
+
+            if (!d->props)
+                return output(reference);
+
+            auto dst{ vsapi->copyFrame(reference, core) };
+            vsapi->freeFrame(reference);
+
+            attachEstimate(dst, d, vsapi);
+            return output(dst);
+        }
+
+        if (d->native) {
+            if (d->sceneDetect)
+                detectCut(current, reference, d, frameCtx, vsapi);
+
+            auto values{ measureFrame(current, reference, d, frameCtx, vsapi,
+                                      map ? reinterpret_cast<float*>(vsapi->getWritePtr(map, 0)) : nullptr,
+                                      map ? vsapi->getStride(map, 0) : 0) };
+
+            if (d->props) {
+                auto dst{ vsapi->copyFrame(reference, core) };
+                vsapi->freeFrame(reference);
+                reference = dst;
+
+                setScoreProps(dst, values, d, vsapi);
+            }
+
+            return output(reference);
+        }
+
+        try {
+            auto&& shards{ d->renditions.front()->shards };
+
+            for (auto position{ current }; position <= current + d->propLag; position++)
+                for (size_t i{ 0 }; i < shards.size(); i++)
+                    if (auto frame{ shards[i]->feedFirst + position }; frame <= shards[i]->feedLast)
+                        feedShards(i, frame, d, frameCtx, vsapi);
+
+            if (d->props) {
+                auto dst{ vsapi->copyFrame(reference, core) };
+                vsapi->freeFrame(reference);
+                reference = dst;
+
+                attachProps(dst, current, d, vsapi);
+            }
+        } catch (const char* error) {
+            vsapi->setFilterError((d->filterName + ": " + error).c_str(), frameCtx);
+            vsapi->freeFrame(reference);
+            vsapi->freeFrame(map);
+            return nullptr;
+        }
+
+        return output(reference);
+    }
+
+    return nullptr;
+}
+
+// Writes the bootstrap scores of every model collection to the collector, which libvmaf's own tool does for each frame as well.
+static void scoreCollections(const VMAFData* d, const Shard* shard, unsigned index) noexcept {
+    for (auto&& collection : d->modelCollection) {
+        VmafModelCollectionScore score;
+        vmaf_score_at_index_model_collection(shard->vmaf, collection, &score, index);
+    }
+}
+
+static void readRow(const VMAFData* d, const Rendition* c, const Shard* shard, unsigned index, std::vector<double>& score,
+                    std::vector<bool>& written) {
+    scoreCollections(d, shard, index);
+
+    for (size_t j{ 0 }; j < c->names.size(); j++)
+        written[j] = !vmaf_feature_score_at_index(shard->vmaf, c->names[j].c_str(), &score[j], index);
+}
+
+// Appends the rows computed by the filter itself in frame order.
+static void collectComputedRows(const VMAFData* d, Rendition* c, bool final) {
+    auto& cursor{ c->cursors.front() };
+
+    for (;;) {
+        unsigned n;
+        std::vector<double> values;
+
+        {
+            std::lock_guard<std::mutex> lock{ c->computedMutex };
+
+            if (c->computed.empty() || (c->computed.begin()->first != cursor.next && !final))
+                break;
+
+            auto node{ c->computed.extract(c->computed.begin()) };
+            n = node.key();
+            values = std::move(node.mapped());
+        }
+
+        for (auto m{ cursor.next }; d->sectioned && m <= n; m++)
+            if (d->cut[m])
+                cursor.piece = m;
+
+        c->writer->append(0, n, cursor.piece, values, c->written);
+        cursor.next = n + 1;
+    }
+}
+
+// Appends every frame that has become final since the last pass, interpolating the skipped ones.
+static void collectRows(const VMAFData* d, Rendition* c, bool final) {
+    if (d->native) {
+        collectComputedRows(d, c, final);
+        return;
+    }
+
+    std::vector<double> values(d->scores.size());
+
+    for (size_t i{ 0 }; i < c->shards.size(); i++) {
+        auto shard{ c->shards[i].get() };
+        auto& cursor{ c->cursors[i] };
+
+        while (cursor.next <= shard->last) {
+            auto n{ cursor.next };
+
+            if (d->sampled[n] == sampleUndecided)
+                break;
+
+            if (c->repeated && c->repeated[n]) {
+                if (d->sectioned && d->cut[n])
+                    cursor.piece = n;
+
+                c->writer->append(i, n, cursor.piece, cursor.scoredScore, cursor.scoredWritten);
+                cursor.next++;
+                continue;
+            }
+
+            if (c->cached && c->cached[n] != cacheMiss) {
+                d->cache->find(c->frameKey[n], &c->score);
+                c->score.resize(c->names.size(), std::numeric_limits<double>::quiet_NaN());
+
+                for (size_t j{ 0 }; j < c->names.size(); j++)
+                    c->written[j] = !std::isnan(c->score[j]);
+
+                if (d->sectioned && d->cut[n])
+                    cursor.piece = n;
+
+                c->writer->append(i, n, cursor.piece, c->score, c->written);
+
+                cursor.scoredFrame = n;
+                cursor.scoredScore = c->score;
+                cursor.scoredWritten = c->written;
+                if (c->cached[n] == cacheRead)
+                    cursor.index++;
+                cursor.next++;
+                continue;
+            }
+
+            // Anchors are interpolated like skipped frames, but each takes the context index before the scored frame after it.
+            if (d->sampled[n] == sampleSkipped || d->sampled[n] == sampleAnchor) {
+                auto following{ n };
+                unsigned anchors{};
+
+                for (; d->sampled[following] == sampleSkipped || d->sampled[following] == sampleAnchor; following++)
+                    anchors += d->sampled[following] == sampleAnchor;
+
+                if (d->sampled[following] == sampleUndecided ||
+                    (!scoresAt(d, shard, cursor.index + anchors, values.data()) && !final))
+                    break;
+
+                readRow(d, c, shard, cursor.index + anchors, c->score, c->written);
+
+                std::vector<double> estimate(c->names.size());
+                std::vector<bool> estimated(c->names.size());
+
+                for (; n < following; n++) {
+                    auto t{ static_cast<double>(n - cursor.scoredFrame) / (following - cursor.scoredFrame) };
+
+                    for (size_t j{ 0 }; j < c->names.size(); j++) {
+                        estimated[j] = cursor.scoredWritten[j] && c->written[j];
+                        estimate[j] = cursor.scoredScore[j] + (c->score[j] - cursor.scoredScore[j]) * t;
+                    }
+
+                    if (d->sectioned && d->cut[n])
+                        cursor.piece = n;
+
+                    c->writer->append(i, n, cursor.piece, estimate, estimated, true);
+                }
+
+                cursor.index += anchors;
+                cursor.next = following;
+                continue;
+            }
+
+            if (!scoresAt(d, shard, cursor.index, values.data()) && !final)
+                break;
+
+            // The frame may have been kept out of the context since, leaving the scores of a later frame.
+            if ((c->repeated && c->repeated[n]) || (c->cached && c->cached[n] != cacheMiss))
+                continue;
+
+            // A frame is only final once it has been fed, so whether it starts a shot is known by now.
+            if (d->sectioned && d->cut[n])
+                cursor.piece = n;
+
+            readRow(d, c, shard, cursor.index, c->score, c->written);
+            c->writer->append(i, n, cursor.piece, c->score, c->written);
+
+            if (d->cache) {
+                std::vector<double> row(c->score);
+                for (size_t j{ 0 }; j < row.size(); j++)
+                    if (!c->written[j])
+                        row[j] = std::numeric_limits<double>::quiet_NaN();
+                d->cache->insert(c->frameKey[n], row);
+            }
+
+            cursor.scoredFrame = n;
+            cursor.scoredScore = c->score;
+            cursor.scoredWritten = c->written;
+            cursor.index++;
+            cursor.next++;
+        }
+    }
+}
+
+// Takes up the score of each drawn frame as libvmaf writes it and updates the estimate.
+static void collectSampledRows(VMAFData* d, Rendition* c) {
+    auto numShards{ c->shards.size() };
+    std::vector<double> values(d->scores.size());
+    auto added{ false };
+
+    for (size_t i{ 0 }; i < numShards; i++) {
+        auto shard{ c->shards[i].get() };
+        auto& cursor{ c->cursors[i] };
+
+        for (size_t s; (s = cursor.next * numShards + i) < d->numFrames; cursor.next++) {
+            auto state{ d->slot[s].load() };
+
+            if (state == slotUndecided)
+                break;
+            if (state == slotSkipped)
+                continue;
+
+            auto k{ d->sampleOrder[s] };
+            auto frames{ slotFrames(d, k) };
+            auto middle{ cursor.index + (frames[0] >= 0) };
+
+            if (!scoresAt(d, shard, middle, values.data()))
+                break;
+
+            readRow(d, c, shard, middle, c->score, c->written);
+            c->sampledRows[k] = { c->score, c->written };
+            c->sample->add(k, values.front());
+            cursor.index += static_cast<unsigned>(std::count_if(frames.cbegin(), frames.cend(),
+                                                                [](int frame) { return frame >= 0; }));
+            added = true;
+        }
+    }
+
+    if (!added)
+        return;
+
+    double mean{ std::numeric_limits<double>::quiet_NaN() };
+    double halfWidth{ std::numeric_limits<double>::quiet_NaN() };
+    c->sample->estimate(d->sampleConfidence, &mean, &halfWidth);
+
+    std::lock_guard<std::mutex> lock{ d->collector.mutex };
+    c->estimate = { mean, halfWidth, c->sample->frames() };
+}
+
+// Sampling stops feeding slots once every estimate is within the margin. Slots already fed by then are still counted.
+static void settleSample(VMAFData* d) {
+    for (auto&& rendition : d->renditions)
+        collectSampledRows(d, rendition.get());
+
+    std::lock_guard<std::mutex> lock{ d->collector.mutex };
+    d->sampleMet = std::all_of(d->renditions.cbegin(), d->renditions.cend(), [&](auto&& rendition) {
+        return rendition->estimate.halfWidth <= d->sampleMargin;
+    });
+}
+
+static void runCollector(VMAFData* d) noexcept {
+    auto&& c{ d->collector };
+    std::unique_lock<std::mutex> lock{ c.mutex };
+
+    while (!c.closing) {
+        lock.unlock();
+        if (d->sampling)
+            settleSample(d);
+        else
+            for (auto&& rendition : d->renditions)
+                collectRows(d, rendition.get(), false);
+        lock.lock();
+
+        c.scored.notify_all();
+
+        // libvmaf cannot report when a score is written, so it is checked for every millisecond while a frame waits for one.
+        auto waiting{ c.waiting };
+        c.wake.wait_for(lock, waiting ? 1ms : 50ms, [&] { return c.closing || c.waiting > waiting; });
+    }
+
+    c.scored.notify_all();
+}
+
+// Writes out the rest of a clip's log once its contexts have been flushed.
+static void finishLog(VMAFData* d, Rendition* c, double fps, const std::function<void(const char*)>& logMessage) {
+    if (d->sampling) {
+        collectSampledRows(d, c);
+
+        for (auto&& [n, row] : c->sampledRows)
+            c->writer->append(0, n, n, row.first, row.second);
+
+        auto&& name{ d->scores.front().name };
+        std::vector<std::pair<std::string, double>> aggregate;
+
+        if (!std::isnan(c->estimate.halfWidth))
+            aggregate = { { name + "_sample_mean", c->estimate.mean },
+                          { name + "_sample_ci_lo", c->estimate.mean - c->estimate.halfWidth },
+                          { name + "_sample_ci_hi", c->estimate.mean + c->estimate.halfWidth },
+                          { name + "_sample_frames", c->estimate.frames } };
+        else
+            logMessage(("too few frames were sampled to estimate the mean for "s + c->logPath).c_str());
+
+        if (!c->writer->close(fps, aggregate, {}))
+            logMessage(("failed to write VMAF stats to "s + c->logPath).c_str());
+        return;
+    }
+
+    collectRows(d, c, true);
+
+    auto&& columns{ c->writer->columnNames() };
+    auto column = [&](const std::string& name) {
+        return static_cast<size_t>(std::find(columns.cbegin(), columns.cend(), name) - columns.cbegin());
+    };
+
+    for (auto&& m : d->modelId)
+        if (double score;
+            column(modelName[m]) == columns.size() || !c->writer->pooled(column(modelName[m]), VMAF_POOL_METHOD_MEAN, &score))
+            logMessage(("failed to generate pooled VMAF score for "s + c->logPath).c_str());
+
+    // The bootstrap aggregates libvmaf reports are the mean pooled per-frame bootstrap scores.
+    std::vector<std::pair<std::string, double>> aggregate;
+
+    for (size_t i{ 0 }; i < d->model.size(); i++) {
+        if (!d->collectionModel[i])
+            continue;
+
+        for (auto&& suffix : { "_bagging", "_stddev", "_ci_p95_lo", "_ci_p95_hi" }) {
+            auto name{ modelName[d->modelId[i]] + std::string{ suffix } };
+
+            if (double score; column(name) != columns.size() && c->writer->pooled(column(name), VMAF_POOL_METHOD_MEAN, &score))
+                aggregate.emplace_back(name, score);
+        }
+    }
+
+    if (d->cache) {
+        aggregate.emplace_back("cache_hits", c->cacheHits.load());
+        aggregate.emplace_back("cache_misses", c->cacheMisses.load());
+    }
+
+    std::vector<unsigned> sectionStarts;
+
+    if (d->sectioned) {
+        sectionStarts.push_back(0);
+        for (unsigned n{ 1 }; n < d->numFrames; n++)
+            if (d->cut[n])
+                sectionStarts.push_back(n);
+    }
+
+    if (!c->writer->close(fps, aggregate, sectionStarts))
+        logMessage(("failed to write VMAF stats to "s + c->logPath).c_str());
+}
+
+static void closeLogs(VMAFData* d, const std::function<void(const char*)>& logMessage) {
+    auto&& c{ d->collector };
+
+    {
+        std::lock_guard<std::mutex> lock{ c.mutex };
+        c.closing = true;
+    }
+
+    c.wake.notify_one();
+    if (c.worker.joinable())
+        c.worker.join();
+
+    auto elapsed{ std::chrono::duration<double>(std::chrono::steady_clock::now() - d->start).count() };
+
+    for (auto&& rendition : d->renditions)
+        finishLog(d, rendition.get(), d->numFrames / elapsed, logMessage);
+}
+
+static void destroyContexts(VMAFData* d) noexcept {
+    for (auto&& m : d->model)
+        vmaf_model_destroy(m);
+    for (auto&& m : d->modelCollection)
+        vmaf_model_collection_destroy(m);
+    for (auto&& rendition : d->renditions)
+        for (auto&& shard : rendition->shards)
+            vmaf_close(shard->vmaf);
+}
+
+static void VS_CC vmafFree(void* instanceData, VSCore* core, const VSAPI* vsapi) {
+    auto d{ static_cast<VMAFData*>(instanceData) };
+
+    vsapi->freeNode(d->reference);
+    for (auto&& rendition : d->renditions)
+        vsapi->freeNode(rendition->distorted);
+
+    auto logMessage = [&](const char* msg, VSMessageType type = mtCritical) noexcept {
+        vsapi->logMessage(type, (d->filterName + ": " + msg).c_str(), core);
+    };
+
+    for (auto&& rendition : d->renditions)
+        for (auto&& shard : rendition->shards)
+            if (auto dropped{ shard->sequencer.close() })
+                logMessage(
+                    ("dropped "s + std::to_string(dropped) + " frames queued after a frame that was never requested").c_str(),
+                    mtWarning);
+
+    for (auto&& rendition : d->renditions)
+        for (auto&& shard : rendition->shards)
+            if (auto failure{ shard->sequencer.flush() })
+                logMessage(failure);
+
+    closeLogs(d, logMessage);
+
+    if (d->cache) {
+        for (auto&& rendition : d->renditions) {
+            auto hits{ rendition->cacheHits.load() };
+            auto lookups{ hits + rendition->cacheMisses.load() };
+            logMessage(("score cache: "s + std::to_string(hits) + " of " + std::to_string(lookups) + " frames found (" +
+                        std::to_string(lookups ? 100 * hits / lookups : 0) + "%) for " + rendition->logPath)
+                           .c_str(),
+                       mtInformation);
+        }
+
+        if (!d->cache->save())
+            logMessage("failed to write the score cache");
+    }
+
+    logMessage(("picture pool: "s + std::to_string(d->pool.hits.load()) + " hits, " + std::to_string(d->pool.misses.load()) +
+                " misses")
+                   .c_str(),
+               mtInformation);
+
+    for (auto&& rendition : d->renditions)
+        if (auto identical{ rendition->identical.load() })
+            logMessage((std::to_string(identical) + " of " + std::to_string(d->numFrames) +
+                        " frames identical to the reference in " + rendition->logPath)
+                           .c_str(),
+                       mtInformation);
+
+    for (auto&& rendition : d->renditions)
+        if (auto repeats{ rendition->repeats.load() })
+            logMessage((std::to_string(repeats) + " of " + std::to_string(d->numFrames) +
+                        " frames reused the scores of a repeated frame in " + rendition->logPath)
+                           .c_str(),
+                       mtInformation);
+
+    if (d->zeroCopy)
+        logMessage(("zero-copy: "s + std::to_string(d->zeroCopyFrames.load()) + " pictures wrapped, " +
+                    std::to_string(d->zeroCopyFallbacks.load()) + " fell back to copy")
+                       .c_str(),
+                   mtInformation);
+
+    destroyContexts(d);
+
+    delete d;
+}
+
+static void createContext(Shard* shard, const VMAFData* d, const VmafConfiguration& configuration) {
+    if (vmaf_init(&shard->vmaf, configuration))
+        throw "failed to initialize VMAF context"s;
 
-static constexpr const char* modelName[]{ "vmaf", "vmaf_neg", "vmaf_b", "vmaf_4k" };
-static constexpr const char* modelVersion[]{ "vmaf_v0.6.1", "vmaf_v0.6.1neg", "vmaf_b_v0.6.3", "vmaf_4k_v0.6.1" };
+    VmafCudaConfiguration cudaConfiguration{};
 
-static constexpr const char* featureName[]{ "psnr", "psnr_hvs", "float_ssim", "float_ms_ssim", "ciede" };
+    if (vmaf_cuda_state_init(&shard->cuState, cudaConfiguration))
+        throw "problem during vmaf_cuda_state_init"s;
 
-struct VMAFData final {
-    std::string filterName;
-    VSNode* reference;
-    VSNode* distorted;
-    const VSVideoInfo* vi;
-    std::string logPath;
-    VmafOutputFormat logFormat;
-    std::vector<VmafModel*> model;
-    std::vector<VmafModelCollection*> modelCollection;
-    VmafContext* vmaf;
-    VmafPixelFormat pixelFormat;
-    VmafCudaState *cu_state;
-    VmafCudaConfiguration cuda_cfg = { 0 };
-    bool chroma;
-};
+    if (vmaf_cuda_import_state(shard->vmaf, shard->cuState))
+        throw "problem during vmaf_cuda_import_state"s;
 
-static const VSFrame* VS_CC vmafGetFrame(int n, int activationReason, void* instanceData, [[maybe_unused]] void** frameData,
-                                         VSFrameContext* frameCtx, [[maybe_unused]] VSCore* core, const VSAPI* vsapi) {
-    auto d{ static_cast<const VMAFData*>(instanceData) };
+    for (size_t i{ 0 }, collection{ 0 }; i < d->model.size(); i++) {
+        if (d->collectionModel[i]) {
+            if (vmaf_use_features_from_model_collection(shard->vmaf, d->modelCollection[collection++]))
+                throw "failed to load feature extractors from model collection: "s + modelVersion[d->modelId[i]];
+        } else if (vmaf_use_features_from_model(shard->vmaf, d->model[i])) {
+            throw "failed to load feature extractors from model: "s + modelVersion[d->modelId[i]];
+        }
+    }
 
-    if (activationReason == arInitial) {
-        vsapi->requestFrameFilter(n, d->reference, frameCtx);
-        vsapi->requestFrameFilter(n, d->distorted, frameCtx);
-    } else if (activationReason == arAllFramesReady) {
-        auto reference{ vsapi->getFrameFilter(n, d->reference, frameCtx) };
-        auto distorted{ vsapi->getFrameFilter(n, d->distorted, frameCtx) };
+    for (auto&& f : d->feature)
+        if (vmaf_use_feature(shard->vmaf, featureName[f], nullptr))
+            throw "failed to load feature extractor: "s + featureName[f];
+}
 
-        VmafPicture ref;
-        VmafPicture dist;
+// The log columns, in the order vmaf_write_output prints them for the models and features in use.
+static void probeColumns(const VMAFData* d, VmafConfiguration configuration, const std::string& path,
+                         std::vector<std::string>* names, std::vector<std::string>* aliases) {
+    constexpr unsigned frames{ 3 };
+    Shard probe{};
+    std::string xml;
 
-        try {
-            if (vmaf_picture_alloc(&ref, d->pixelFormat, d->vi->format.bitsPerSample, d->vi->width, d->vi->height) ||
-                vmaf_picture_alloc(&dist, d->pixelFormat, d->vi->format.bitsPerSample, d->vi->width, d->vi->height))
-                throw "failed to allocate picture";
+    configuration.n_threads = 0;
 
-            for (auto plane{ 0 }; plane < d->vi->format.numPlanes; plane++) {
-                if (plane && !d->chroma)
-                    break;
+    try {
+        createContext(&probe, d, configuration);
+
+        auto bitsPerSample{ static_cast<unsigned>(d->vi->format.bitsPerSample) };
+        auto mask{ (1u << bitsPerSample) - 1 };
+
+        for (unsigned i{ 0 }; i < frames; i++) {
+            VmafPicture pics[2]{};
+
+            for (auto p{ 0 }; p < 2; p++) {
+                auto&& pic{ pics[p] };
+
+                if (vmaf_picture_alloc(&pic, d->pixelFormat, bitsPerSample, d->pictureWidth, d->pictureHeight)) {
+                    vmaf_picture_unref(&pics[0]);
+                    throw "failed to allocate pictures"s;
+                }
 
-                vsh::bitblt(ref.data[plane],
-                            ref.stride[plane],
-                            vsapi->getReadPtr(reference, plane),
-                            vsapi->getStride(reference, plane),
-                            vsapi->getFrameWidth(reference, plane) * d->vi->format.bytesPerSample,
-                            vsapi->getFrameHeight(reference, plane));
+                for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+                    for (unsigned y{ 0 }; y < pic.h[plane]; y++) {
+                        auto row{ static_cast<uint8_t*>(pic.data[plane]) + pic.stride[plane] * y };
 
-                vsh::bitblt(dist.data[plane],
-                            dist.stride[plane],
-                            vsapi->getReadPtr(distorted, plane),
-                            vsapi->getStride(distorted, plane),
-                            vsapi->getFrameWidth(distorted, plane) * d->vi->format.bytesPerSample,
-                            vsapi->getFrameHeight(distorted, plane));
+                        for (unsigned x{ 0 }; x < pic.w[plane]; x++) {
+                            auto value{ ((x * 7 + y * 13 + i * 29) & mask) ^ static_cast<unsigned>(p) };
+
+                            if (bitsPerSample > 8)
+                                reinterpret_cast<uint16_t*>(row)[x] = static_cast<uint16_t>(value);
+                            else
+                                row[x] = static_cast<uint8_t>(value);
+                        }
+                    }
+                }
             }
 
-            if (vmaf_read_pictures(d->vmaf, &ref, &dist, n))
-                throw "failed to read pictures";
-        } catch (const char* error) {
-            vsapi->setFilterError((d->filterName + ": " + error).c_str(), frameCtx);
+            if (vmaf_read_pictures(probe.vmaf, &pics[0], &pics[1], i)) {
+                vmaf_picture_unref(&pics[0]);
+                vmaf_picture_unref(&pics[1]);
+                throw "failed to read pictures"s;
+            }
+        }
 
-            vsapi->freeFrame(reference);
-            vsapi->freeFrame(distorted);
+        if (vmaf_read_pictures(probe.vmaf, nullptr, nullptr, 0))
+            throw "failed to flush context"s;
 
-            vmaf_picture_unref(&ref);
-            vmaf_picture_unref(&dist);
+        // In the order collectRows asks for them, so that the model scores are registered in the same place.
+        std::vector<double> values(d->scores.size());
+        for (unsigned i{ 0 }; i < frames; i++) {
+            scoresAt(d, &probe, i, values.data());
+            scoreCollections(d, &probe, i);
+        }
 
-            return nullptr;
+        if (vmaf_write_output(probe.vmaf, path.c_str(), VMAF_OUTPUT_FORMAT_XML))
+            throw "failed to write "s + path;
+
+        std::unique_ptr<FILE, decltype(&fclose)> file{ fopen(path.c_str(), "rb"), fclose };
+        if (!file)
+            throw "failed to read "s + path;
+
+        char buffer[4096];
+        for (size_t length; (length = fread(buffer, 1, sizeof(buffer), file.get())) > 0;)
+            xml.append(buffer, length);
+    } catch (...) {
+        std::remove(path.c_str());
+        if (probe.vmaf)
+            vmaf_close(probe.vmaf);
+        throw;
+    }
+
+    std::remove(path.c_str());
+
+    // A name missing from an earlier frame goes right after the one before it.
+    for (size_t pos{}; (pos = xml.find("<frame ", pos)) != std::string::npos;) {
+        auto end{ xml.find("/>", pos) };
+        size_t insert{};
+
+        for (auto at{ xml.find(' ', pos) }; at < end && xml[at] == ' ';) {
+            auto equals{ xml.find('=', at) };
+            if (equals >= end)
+                break;
+
+            std::string alias{ xml, at + 1, equals - at - 1 };
+            if (alias != "frameNum") {
+                auto found{ std::find(aliases->begin(), aliases->end(), alias) };
+                if (found == aliases->end())
+                    found = aliases->insert(aliases->begin() + insert, alias);
+                insert = found - aliases->begin() + 1;
+            }
+
+            at = xml.find('"', equals + 2) + 1;
         }
 
-        vsapi->freeFrame(distorted);
-        return reference;
+        pos = end;
     }
 
-    return nullptr;
+    for (auto&& alias : *aliases) {
+        std::vector<std::string> candidates{ alias, "VMAF_feature_" + alias + "_score" };
+        if (alias.compare(0, 8, "integer_") == 0)
+            candidates.push_back("VMAF_integer_feature_" + alias.substr(8) + "_score");
+
+        auto resolved = [&](const std::string& name) {
+            for (unsigned i{ 0 }; i < frames; i++)
+                if (double score; !vmaf_feature_score_at_index(probe.vmaf, name.c_str(), &score, i))
+                    return true;
+            return false;
+        };
+
+        auto name{ std::find_if(candidates.cbegin(), candidates.cend(), resolved) };
+        if (name == candidates.cend()) {
+            vmaf_close(probe.vmaf);
+            throw "failed to find the libvmaf feature logged as "s + alias;
+        }
+
+        names->push_back(*name);
+    }
+
+    vmaf_close(probe.vmaf);
+
+    if (aliases->empty())
+        throw "libvmaf reported no scores for the models and features in use"s;
 }
 
-static void VS_CC vmafFree(void* instanceData, VSCore* core, const VSAPI* vsapi) {
-    auto d{ static_cast<VMAFData*>(instanceData) };
+// Locks in the active area of the first evaluated frames of the reference as the region of interest.
+static void detectCrop(VMAFData* d, int frames, const VSAPI* vsapi) {
+    ActiveArea area{ static_cast<unsigned>(d->vi->width), static_cast<unsigned>(d->vi->height), d->vi->format.bitsPerSample };
 
-    vsapi->freeNode(d->reference);
-    vsapi->freeNode(d->distorted);
+    for (auto n{ 0 }; n < frames; n++) {
+        char errorMsg[1024];
+        auto frame{ vsapi->getFrame(d->first + n, d->reference, errorMsg, sizeof(errorMsg)) };
 
-    static auto logMessage = [&](const char* msg) noexcept {
-        vsapi->logMessage(mtCritical, (d->filterName + ": " + msg).c_str(), core);
-    };
+        if (!frame)
+            throw "autocrop failed to get frame: "s + errorMsg;
 
-    if (vmaf_read_pictures(d->vmaf, nullptr, nullptr, 0))
-        logMessage("failed to flush context");
+        area.add(vsapi->getReadPtr(frame, 0), vsapi->getStride(frame, 0), d->vi->format.bitsPerSample);
+        vsapi->freeFrame(frame);
+    }
 
-    for (auto&& m : d->model)
-        if (double score; vmaf_score_pooled(d->vmaf, m, VMAF_POOL_METHOD_MEAN, &score, 0, d->vi->numFrames - 1))
-            logMessage("failed to generate pooled VMAF score");
+    d->cropDetected = true;
 
-    for (auto&& m : d->modelCollection)
-        if (VmafModelCollectionScore score; vmaf_score_pooled_model_collection(d->vmaf, m, VMAF_POOL_METHOD_MEAN, &score, 0, d->vi->numFrames - 1))
-            logMessage("failed to generate pooled VMAF score");
+    if (!area.bounds(&d->cropLeft, &d->cropRight, &d->cropTop, &d->cropBottom))
+        return;
 
-    if (vmaf_write_output(d->vmaf, d->logPath.c_str(), d->logFormat))
-        logMessage("failed to write VMAF stats");
+    auto roundUp = [](int value, int subSampling) {
+        return (value + (1 << subSampling) - 1) >> subSampling << subSampling;
+    };
 
-    for (auto&& m : d->model)
-        vmaf_model_destroy(m);
-    for (auto&& m : d->modelCollection)
-        vmaf_model_collection_destroy(m);
-    vmaf_close(d->vmaf);
+    d->cropLeft = roundUp(d->cropLeft, d->vi->format.subSamplingW);
+    d->cropRight = roundUp(d->cropRight, d->vi->format.subSamplingW);
+    d->cropTop = roundUp(d->cropTop, d->vi->format.subSamplingH);
+    d->cropBottom = roundUp(d->cropBottom, d->vi->format.subSamplingH);
 
-    delete d;
+    // A single active line rounded inwards from both sides could vanish; score the whole picture rather than nothing.
+    if (d->cropLeft + d->cropRight >= d->vi->width || d->cropTop + d->cropBottom >= d->vi->height)
+        d->cropLeft = d->cropRight = d->cropTop = d->cropBottom = 0;
 }
 
 static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore* core, const VSAPI* vsapi) {
@@ -158,18 +2129,22 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
 
     try {
         d->filterName = static_cast<const char*>(userData);
-
+        d->start = std::chrono::steady_clock::now();
 
         d->reference = vsapi->mapGetNode(in, "reference", 0, nullptr);
-        d->distorted = vsapi->mapGetNode(in, "distorted", 0, nullptr);
+
+        for (auto i{ 0 }; i < vsapi->mapNumElements(in, "distorted"); i++) {
+            auto& rendition{ d->renditions.emplace_back(std::make_unique<Rendition>()) };
+            rendition->distorted = vsapi->mapGetNode(in, "distorted", i, nullptr);
+        }
 
         d->vi = vsapi->getVideoInfo(d->reference);
         int err;
 
         if (!vsh::isConstantVideoFormat(d->vi) ||
-            d->vi->format.colorFamily != cfYUV ||
+            (d->vi->format.colorFamily != cfGray && d->vi->format.colorFamily != cfYUV) ||
             d->vi->format.sampleType != stInteger)
-            throw "only constant YUV format integer input supported";
+            throw "only constant Gray or YUV format integer input supported"s;
 
         switch (d->vi->format.bitsPerSample) {
         case 8:
@@ -178,56 +2153,243 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
         case 16:
             break;
         default:
-            throw "only 8, 10, 12 and 16 bit depth supported";
+            throw "only 8, 10, 12 and 16 bit depth supported"s;
         }
 
-        if (!((d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 1) ||
+        if (d->vi->format.colorFamily == cfYUV &&
+            !((d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 1) ||
               (d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 0) ||
               (d->vi->format.subSamplingW == 0 && d->vi->format.subSamplingH == 0)))
             throw "only 420/422/444 chroma subsampling is supported"s;
 
-        d->logPath = vsapi->mapGetData(in, "log_path", 0, nullptr);
+        // Either one path per distorted clip, or a single path in which {} stands for the index of the clip.
+        auto numLogPaths{ vsapi->mapNumElements(in, "log_path") };
+
+        if (numLogPaths != static_cast<int>(d->renditions.size()) && numLogPaths != 1)
+            throw "log_path must have one entry per distorted clip"s;
+
+        for (size_t i{ 0 }; i < d->renditions.size(); i++) {
+            std::string logPath{ vsapi->mapGetData(in, "log_path", numLogPaths > 1 ? static_cast<int>(i) : 0, nullptr) };
+
+            if (numLogPaths == 1 && d->renditions.size() > 1) {
+                auto placeholder{ logPath.find("{}") };
+                if (placeholder == std::string::npos)
+                    throw "log_path must contain {} when it is shared by several distorted clips"s;
+                logPath.replace(placeholder, 2, std::to_string(i));
+            }
+
+            d->renditions[i]->logPath = std::move(logPath);
+        }
+
         auto logFormat{ vsapi->mapGetIntSaturated(in, "log_format", 0, &err) };
 
-        if (logFormat < 0 || logFormat > 3)
-            throw "log_format must be 0, 1, 2, or 3"s;
+        if (logFormat < 0 || logFormat > 4)
+            throw "log_format must be 0, 1, 2, 3, or 4"s;
 
         d->logFormat = static_cast<VmafOutputFormat>(logFormat + 1);
 
+        if (d->logFormat == outputFormatBinary) {
+            constexpr uint16_t probe{ 1 };
+            if (*reinterpret_cast<const uint8_t*>(&probe) != 1)
+                throw "log_format=4 requires a little-endian host"s;
+        }
+
+        d->zeroCopy = !!vsapi->mapGetInt(in, "zero_copy", 0, &err);
+
+#ifndef VMAF_PRIVATE_API
+        if (d->zeroCopy)
+            throw "zero_copy requires a build against a libvmaf that exports its private picture symbols"s;
+#endif
+
         VSCoreInfo info;
         vsapi->getCoreInfo(core, &info);
 
-        VmafConfiguration configuration{};
-        configuration.log_level = VMAF_LOG_LEVEL_INFO;
-        configuration.n_threads = info.numThreads;
-        configuration.n_subsample = 1;
-        configuration.cpumask = 0;
+        auto queueDepth{ vsapi->mapGetIntSaturated(in, "queue_depth", 0, &err) };
+
+        if (queueDepth < 0)
+            throw "queue_depth must be greater than or equal to 0"s;
+
+        auto props{ !!vsapi->mapGetInt(in, "props", 0, &err) };
+
+        d->propLag = vsapi->mapGetIntSaturated(in, "prop_lag", 0, &err);
+        if (err)
+            d->propLag = 1;
+
+        if (d->propLag < 0)
+            throw "prop_lag must be greater than or equal to 0"s;
+
+        if (!props)
+            d->propLag = 0;
+
+        d->propTimeout = vsapi->mapGetFloat(in, "prop_timeout", 0, &err);
+
+        if (d->propTimeout < 0.0)
+            throw "prop_timeout must be greater than or equal to 0.0"s;
+
+        auto numShards{ vsapi->mapGetIntSaturated(in, "shards", 0, &err) };
+        if (err)
+            numShards = 1;
+
+        if (numShards < 1)
+            throw "shards must be greater than or equal to 1"s;
+
+        auto first{ vsapi->mapGetIntSaturated(in, "first", 0, &err) };
+
+        auto last{ vsapi->mapGetIntSaturated(in, "last", 0, &err) };
+        if (err)
+            last = d->vi->numFrames - 1;
+
+        if (first < 0 || last >= d->vi->numFrames || first > last)
+            throw "first and last must satisfy 0 <= first <= last < number of frames"s;
+
+        d->first = first;
+        d->numFrames = last - first + 1;
+
+        numShards = std::min(numShards, static_cast<int>(d->numFrames));
+
+        d->sceneDetect = vsapi->mapGetIntSaturated(in, "scene_detect", 0, &err);
+
+        if (d->sceneDetect < 0 || d->sceneDetect > 2)
+            throw "scene_detect must be 0, 1, or 2"s;
+
+        d->sceneThreshold = vsapi->mapGetFloat(in, "scene_threshold", 0, &err);
+        if (err)
+            d->sceneThreshold = 0.1;
+
+        if (d->sceneThreshold <= 0.0 || d->sceneThreshold >= 1.0)
+            throw "scene_threshold must be between 0.0 and 1.0 (exclusive)"s;
+
+        auto segments{ vsapi->mapGetIntArray(in, "segments", &err) };
+        auto numSegments{ vsapi->mapNumElements(in, "segments") };
+
+        d->cut = std::make_unique<std::atomic<bool>[]>(d->numFrames);
+        d->sectioned = d->sceneDetect || numSegments > 0;
+
+        for (auto i{ 0 }; i < numSegments; i++) {
+            if (segments[i] < d->first || segments[i] >= d->first + static_cast<int64_t>(d->numFrames))
+                throw "segments must lie within the evaluated frames"s;
+
+            d->cut[segments[i] - d->first] = true;
+        }
+
+        d->subsample = vsapi->mapGetIntSaturated(in, "subsample", 0, &err);
+        if (err)
+            d->subsample = 1;
+
+        if (d->subsample < 1)
+            throw "subsample must be greater than or equal to 1"s;
+
+        d->subsampleIframes = !!vsapi->mapGetInt(in, "subsample_iframes", 0, &err);
+
+        d->cascade = vsapi->mapGetFloat(in, "cascade", 0, &err);
+
+        if (d->cascade < 0.0)
+            throw "cascade must be greater than or equal to 0.0"s;
+
+        // The frame props carry each frame's own scores, which a skipped frame does not have when it is returned.
+        if (props && (d->subsample > 1 || d->cascade > 0.0))
+            throw "props cannot be used with subsample or cascade"s;
+
+        d->sampleMargin = vsapi->mapGetFloat(in, "sample_margin", 0, &err);
+        d->sampling = !err;
+
+        if (d->sampling && d->sampleMargin <= 0.0)
+            throw "sample_margin must be greater than 0.0"s;
 
+        d->sampleConfidence = vsapi->mapGetFloat(in, "sample_confidence", 0, &err);
+        if (err)
+            d->sampleConfidence = 0.95;
 
+        if (d->sampleConfidence <= 0.0 || d->sampleConfidence >= 1.0)
+            throw "sample_confidence must be between 0.0 and 1.0 (exclusive)"s;
 
-        if (vmaf_init(&d->vmaf, configuration))
-            throw "failed to initialize VMAF context"s;
+        auto sampleStrata{ vsapi->mapGetIntSaturated(in, "sample_strata", 0, &err) };
+        if (err)
+            sampleStrata = 16;
 
-        if (vmaf_cuda_state_init(&d->cu_state, d->cuda_cfg))
-            throw "problem during vmaf_cuda_state_init";
+        if (sampleStrata < 1)
+            throw "sample_strata must be greater than or equal to 1"s;
 
-        if (vmaf_cuda_import_state(d->vmaf, d->cu_state))
-            throw "problem during vmaf_cuda_import_state";
+        d->sampleStrata = sampleStrata;
 
+        // Sampling feeds the frame each output frame draws, so props never wait for a later one.
+        if (d->sampling) {
+            if (d->subsample > 1 || d->cascade > 0.0 || d->sectioned)
+                throw "sample_margin cannot be combined with subsample, cascade, segments or scene_detect"s;
 
-        if (!vsh::isSameVideoInfo(vsapi->getVideoInfo(d->distorted), d->vi))
-            throw "both clips must have the same format and dimensions"s;
+            d->propLag = 0;
+        }
+
+        d->cropLeft = vsapi->mapGetIntSaturated(in, "crop_left", 0, &err);
+        d->cropRight = vsapi->mapGetIntSaturated(in, "crop_right", 0, &err);
+        d->cropTop = vsapi->mapGetIntSaturated(in, "crop_top", 0, &err);
+        d->cropBottom = vsapi->mapGetIntSaturated(in, "crop_bottom", 0, &err);
+
+        if (d->cropLeft < 0 || d->cropRight < 0 || d->cropTop < 0 || d->cropBottom < 0)
+            throw "crop_left, crop_right, crop_top and crop_bottom must be greater than or equal to 0"s;
+
+        auto autocrop{ vsapi->mapGetIntSaturated(in, "autocrop", 0, &err) };
+
+        if (autocrop < 0)
+            throw "autocrop must be greater than or equal to 0"s;
+
+        if (autocrop && (d->cropLeft || d->cropRight || d->cropTop || d->cropBottom))
+            throw "autocrop cannot be combined with crop_left, crop_right, crop_top or crop_bottom"s;
+
+        if (autocrop)
+            detectCrop(d.get(), std::min(autocrop, static_cast<int>(d->numFrames)), vsapi);
+
+        d->width = d->vi->width - d->cropLeft - d->cropRight;
+        d->height = d->vi->height - d->cropTop - d->cropBottom;
+
+        if (d->width < 1 || d->height < 1)
+            throw "cropping must leave at least one pixel"s;
+
+        if (((d->cropLeft | d->cropRight) & ((1 << d->vi->format.subSamplingW) - 1)) ||
+            ((d->cropTop | d->cropBottom) & ((1 << d->vi->format.subSamplingH) - 1)))
+            throw "cropping must respect the chroma subsampling"s;
+
+        // Preview scores pictures of half the region of interest, rounded down to whole chroma samples.
+        d->preview = !!vsapi->mapGetInt(in, "preview", 0, &err);
+        d->pictureWidth = d->width;
+        d->pictureHeight = d->height;
+
+        if (d->preview) {
+            d->pictureWidth = d->width / 2 >> d->vi->format.subSamplingW << d->vi->format.subSamplingW;
+            d->pictureHeight = d->height / 2 >> d->vi->format.subSamplingH << d->vi->format.subSamplingH;
+            d->zeroCopy = false;
+
+            if (d->pictureWidth < 1 || d->pictureHeight < 1)
+                throw "preview needs a region of interest of at least two chroma samples in each direction"s;
+        }
+
+        auto scaler{ vsapi->mapGetIntSaturated(in, "scaler", 0, &err) };
+        auto scale{ !err };
+
+        if (scale && (scaler < 0 || scaler > 1))
+            throw "scaler must be 0 or 1"s;
 
-        if (vsapi->getVideoInfo(d->distorted)->numFrames != d->vi->numFrames)
-            throw "both clips' number of frames do not match"s;
+        for (auto&& rendition : d->renditions) {
+            auto vi{ vsapi->getVideoInfo(rendition->distorted) };
+
+            if (!vsh::isSameVideoInfo(vi, d->vi) &&
+                !(scale && vsh::isConstantVideoFormat(vi) && vsh::isSameVideoFormat(&vi->format, &d->vi->format)))
+                throw "both clips must have the same format and dimensions"s;
+
+            if (vi->numFrames != d->vi->numFrames)
+                throw "both clips' number of frames do not match"s;
+        }
 
         auto model{ vsapi->mapGetIntArray(in, "model", &err) };
         auto numModels{ vsapi->mapNumElements(in, "model") };
         auto feature{ vsapi->mapGetIntArray(in, "feature", &err) };
         auto numFeatures{ vsapi->mapNumElements(in, "feature") };
 
-        if (numModels > 0)
+        if (numModels > 0) {
+            d->modelId.resize(numModels);
+            d->collectionModel.resize(numModels);
             d->model.resize(numModels);
+        }
 
         for (auto i{ 0 }; i < numModels; i++) {
             if (model[i] < 0 || model[i] > 3)
@@ -236,6 +2398,8 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
             if (std::count(model, model + numModels, model[i]) > 1)
                 throw "duplicate model specified"s;
 
+            d->modelId[i] = static_cast<int>(model[i]);
+
             VmafModelConfig modelConfig{};
             modelConfig.name = modelName[model[i]];
             modelConfig.flags = VMAF_MODEL_FLAGS_DEFAULT;
@@ -246,14 +2410,8 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
                 if (vmaf_model_collection_load(&d->model[i], &d->modelCollection[d->modelCollection.size() - 1], &modelConfig, modelVersion[model[i]]))
                     throw "failed to load model: "s + modelVersion[model[i]];
 
-                if (vmaf_use_features_from_model_collection(d->vmaf, d->modelCollection[d->modelCollection.size() - 1]))
-                    throw "failed to load feature extractors from model collection: "s + modelVersion[model[i]];
-
-                continue;
+                d->collectionModel[i] = true;
             }
-
-            if (vmaf_use_features_from_model(d->vmaf, d->model[i]))
-                throw "failed to load feature extractors from model: "s + modelVersion[model[i]];
         }
 
         for (auto i{ 0 }; i < numFeatures; i++) {
@@ -263,8 +2421,10 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
             if (std::count(feature, feature + numFeatures, feature[i]) > 1)
                 throw "duplicate feature specified"s;
 
-            if (vmaf_use_feature(d->vmaf, featureName[feature[i]], nullptr))
-                throw "failed to load feature extractor: "s + featureName[feature[i]];
+            if (d->vi->format.colorFamily == cfGray && (feature[i] == 1 || feature[i] == 4))
+                throw "feature "s + featureName[feature[i]] + " requires YUV input";
+
+            d->feature.push_back(static_cast<int>(feature[i]));
 
             switch (feature[i]) {
             case 0:
@@ -274,30 +2434,365 @@ static void VS_CC vmafCreate(const VSMap* in, VSMap* out, void* userData, VSCore
             }
         }
 
-        if (d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 1)
+        // The VMAF models only look at luma, so unless a feature needs chroma the pictures carry the luma plane alone.
+        if (d->vi->format.colorFamily == cfGray || !d->chroma)
+            d->pixelFormat = VMAF_PIX_FMT_YUV400P;
+        else if (d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 1)
             d->pixelFormat = VMAF_PIX_FMT_YUV420P;
         else if (d->vi->format.subSamplingW == 1 && d->vi->format.subSamplingH == 0)
             d->pixelFormat = VMAF_PIX_FMT_YUV422P;
         else
             d->pixelFormat = VMAF_PIX_FMT_YUV444P;
+
+        d->props = props;
+
+        // A model's motion score of frame n needs frame n + 1, which inline nothing reads while frame n waits for its scores.
+        if (props && !d->sampling && !d->model.empty() && d->propLag < 1)
+            throw "prop_lag must be greater than or equal to 1 with a model"s;
+
+        // The region of interest maps onto the same part of a distorted clip of another size.
+        auto regionWidth{ d->preview ? d->pictureWidth * 2 : d->width };
+        auto regionHeight{ d->preview ? d->pictureHeight * 2 : d->height };
+
+        for (auto&& rendition : d->renditions) {
+            auto vi{ vsapi->getVideoInfo(rendition->distorted) };
+
+            if (vi->width == d->vi->width && vi->height == d->vi->height)
+                continue;
+
+            if (d->cascade > 0.0)
+                throw "cascade requires distorted clips of the reference's size"s;
+
+            for (auto plane{ 0 }; plane < pictureNumPlanes(d->pixelFormat); plane++) {
+                auto ssW{ plane ? d->vi->format.subSamplingW : 0 };
+                auto ssH{ plane ? d->vi->format.subSamplingH : 0 };
+                auto scaleX{ static_cast<double>(vi->width >> ssW) / (d->vi->width >> ssW) };
+                auto scaleY{ static_cast<double>(vi->height >> ssH) / (d->vi->height >> ssH) };
+
+                rendition->resizers.emplace_back(static_cast<Scaler>(scaler), vi->width >> ssW, vi->height >> ssH,
+                                                 (d->cropLeft >> ssW) * scaleX, (d->cropTop >> ssH) * scaleY,
+                                                 (regionWidth >> ssW) * scaleX, (regionHeight >> ssH) * scaleY,
+                                                 d->pictureWidth >> ssW, d->pictureHeight >> ssH);
+            }
+        }
+
+        // Native features are computed per frame in parallel, opt-in as they do not reproduce libvmaf's scores exactly.
+        auto native{ !!vsapi->mapGetInt(in, "native", 0, &err) };
+
+        d->native = native && d->model.empty() && !d->feature.empty() && !d->preview && !d->sampling && d->subsample == 1 &&
+                    d->cascade <= 0.0 &&
+                    std::all_of(d->renditions.cbegin(), d->renditions.cend(),
+                                [](auto&& rendition) { return rendition->resizers.empty(); });
+
+        if (d->native)
+            d->propLag = 0;
+
+        if (d->native && std::count(d->feature.cbegin(), d->feature.cend(), 4))
+            d->ciede = std::make_unique<CIEDE2000>(d->vi->format.bitsPerSample);
+
+        d->psnrHVS = d->native && std::count(d->feature.cbegin(), d->feature.cend(), 1);
+
+        if (d->psnrHVS && d->vi->format.bitsPerSample > 12)
+            throw "native PSNR-HVS requires a bit depth of at most 12"s;
+
+        if (d->native && std::count(d->feature.cbegin(), d->feature.cend(), 3) &&
+            (static_cast<unsigned>(d->width) < msssimMinimumSize || static_cast<unsigned>(d->height) < msssimMinimumSize))
+            throw "MS-SSIM requires at least "s + std::to_string(msssimMinimumSize) + "x" + std::to_string(msssimMinimumSize) +
+                " samples";
+
+        // The map is attached to the returned frames as _SSIMMap, against a single distorted clip.
+        d->ssimMap = !!vsapi->mapGetInt(in, "ssim_map", 0, &err);
+
+        if (d->ssimMap) {
+            if (d->renditions.size() > 1 || !d->renditions.front()->resizers.empty())
+                throw "ssim_map requires a single distorted clip of the reference's size"s;
+
+            unsigned mapWidth;
+            unsigned mapHeight;
+            ssimMapSize(d->width, d->height, &mapWidth, &mapHeight);
+
+            if (static_cast<int>(mapWidth) < 1 || static_cast<int>(mapHeight) < 1)
+                throw "ssim_map requires a region of interest larger than the SSIM window"s;
+
+            d->mapInfo = *d->vi;
+            vsapi->queryVideoFormat(&d->mapInfo.format, cfGray, stFloat, 32, 0, 0, core);
+            d->mapInfo.width = mapWidth;
+            d->mapInfo.height = mapHeight;
+        }
+
+        // Cached frames take no context index, so the cache is unavailable where scores are read by index.
+        if (auto cachePath{ vsapi->mapGetData(in, "cache_path", 0, &err) }; !err) {
+            if ((d->props && !d->native) || d->subsample > 1 || d->cascade > 0.0 || d->sampling || d->ssimMap)
+                throw "cache_path cannot be combined with props, subsample, cascade, sample_margin or ssim_map"s;
+
+            d->cache = std::make_unique<ScoreCache>(cachePath);
+
+            if (!d->cache->load())
+                throw "cache_path is not a score cache: "s + cachePath;
+        }
+
+        {
+            static constexpr const char* modelProp[]{ "_VMAF", "_VMAF_NEG", "_VMAF_B", "_VMAF_4K" };
+
+            for (size_t i{ 0 }; i < d->model.size(); i++)
+                d->scores.push_back({ modelProp[d->modelId[i]], modelName[d->modelId[i]], d->model[i] });
+
+            auto chromaScores{ pictureNumPlanes(d->pixelFormat) > 1 };
+
+            for (auto&& f : d->feature) {
+                switch (f) {
+                case 0:
+                    d->scores.push_back({ "_PSNR_Y", "psnr_y", nullptr });
+                    if (chromaScores) {
+                        d->scores.push_back({ "_PSNR_CB", "psnr_cb", nullptr });
+                        d->scores.push_back({ "_PSNR_CR", "psnr_cr", nullptr });
+                    }
+                    break;
+                case 1:
+                    // Natively these are the log's columns, which libvmaf's extractor writes with the combined score last.
+                    if (!d->native)
+                        d->scores.push_back({ "_PSNR_HVS", "psnr_hvs", nullptr });
+                    d->scores.push_back({ "_PSNR_HVS_Y", "psnr_hvs_y", nullptr });
+                    d->scores.push_back({ "_PSNR_HVS_CB", "psnr_hvs_cb", nullptr });
+                    d->scores.push_back({ "_PSNR_HVS_CR", "psnr_hvs_cr", nullptr });
+                    if (d->native)
+                        d->scores.push_back({ "_PSNR_HVS", "psnr_hvs", nullptr });
+                    break;
+                case 2:
+                    d->scores.push_back({ "_SSIM", "float_ssim", nullptr });
+                    break;
+                case 3:
+                    d->scores.push_back({ "_MS_SSIM", "float_ms_ssim", nullptr });
+                    break;
+                case 4:
+                    d->scores.push_back({ "_CIEDE2000", "ciede2000", nullptr });
+                }
+            }
+        }
+
+        // Rows are only reused under the same metrics, pictures and libvmaf.
+        if (d->cache) {
+            std::string config{ "libvmaf "s + vmaf_version() + (d->native ? " native" : "") + " scores" };
+
+            for (auto&& score : d->scores)
+                config += " " + score.name;
+
+            config += " format " + std::to_string(d->pixelFormat) + " " + std::to_string(d->vi->format.bitsPerSample) +
+                      " region " + std::to_string(d->width) + "x" + std::to_string(d->height) + " picture " +
+                      std::to_string(d->pictureWidth) + "x" + std::to_string(d->pictureHeight) + (d->preview ? " preview" : "");
+
+            for (auto&& rendition : d->renditions) {
+                auto vi{ vsapi->getVideoInfo(rendition->distorted) };
+                auto scaled{ rendition->resizers.empty()
+                                 ? ""s
+                                 : " scaled " + std::to_string(scaler) + " from " + std::to_string(vi->width) + "x" +
+                                       std::to_string(vi->height) };
+                rendition->cacheConfig = ScoreCache::hash(config + scaled);
+            }
+        }
+
+        // Without a model, a frame identical to the reference can have its scores imported.
+        if (!d->native && d->model.empty() && !d->sampling &&
+            std::all_of(d->feature.cbegin(), d->feature.cend(), [](int f) { return f == 0 || f == 2 || f == 3; }))
+            for (auto&& score : d->scores)
+                d->perfectScores.emplace_back(score.name, perfectScore(score.name, d.get()));
+
+        auto numContexts{ numShards * static_cast<int>(d->renditions.size()) };
+
+        VmafConfiguration configuration{};
+        configuration.log_level = VMAF_LOG_LEVEL_INFO;
+        configuration.n_threads = std::max(info.numThreads / numContexts, 1);
+        configuration.n_subsample = 1;
+        configuration.cpumask = 0;
+
+        // At most one request per thread plus its prop_lag frames runs ahead, and a sampling slot takes three positions.
+        auto reorderWindow{ std::max(static_cast<unsigned>(queueDepth), static_cast<unsigned>(info.numThreads + d->propLag)) *
+                            (d->sampling ? 3 : 1) };
+
+        std::vector<std::string> columnNames;
+        std::vector<std::string> columnAliases;
+
+        // The native path has no contexts, shards or pictures.
+        if (!d->native) {
+            for (auto&& rendition : d->renditions) {
+                for (auto i{ 0 }; i < numShards; i++) {
+                    auto& shard{ rendition->shards.emplace_back(std::make_unique<Shard>()) };
+                    auto length{ static_cast<int>(d->numFrames) / numShards };
+                    auto remainder{ static_cast<int>(d->numFrames) % numShards };
+
+                    shard->first = i * length + std::min(i, remainder);
+                    shard->last = shard->first + length + (i < remainder) - 1;
+                    shard->feedFirst = shard->first ? shard->first - 1 : 0;
+                    shard->feedLast = std::min(shard->last + 1, d->numFrames - 1);
+
+                    createContext(shard.get(), d.get(), configuration);
+                }
+            }
+
+            // Room for a full reorder buffer in each context plus the pictures libvmaf's workers still hold.
+            auto capacity{ (d->renditions.size() + 1) * numShards *
+                           (static_cast<size_t>(reorderWindow) + configuration.n_threads + 1) };
+            d->pool.init({ d->pixelFormat, static_cast<unsigned>(d->vi->format.bitsPerSample),
+                           static_cast<unsigned>(d->pictureWidth), static_cast<unsigned>(d->pictureHeight) },
+                         capacity, 2);
+
+            probeColumns(d.get(), configuration, d->renditions.front()->logPath + ".columns.xml", &columnNames, &columnAliases);
+
+            // Rows are stored in the order of the columns, so a cache only reuses rows stored under the same ones.
+            std::string columns;
+            for (auto&& name : columnNames)
+                columns += name + " ";
+
+            for (auto&& rendition : d->renditions) {
+                rendition->names = columnNames;
+                rendition->cacheConfig = ScoreCache::combine(rendition->cacheConfig, ScoreCache::hash(columns));
+            }
+        }
+
+        // Every subsample-th frame and both ends of each shard are scored, and the rest are decided when fed.
+        d->sampled = std::make_unique<std::atomic<uint8_t>[]>(d->numFrames);
+        d->screen = std::make_unique<std::atomic<double>[]>(d->numFrames);
+
+        for (unsigned n{ 0 }; n < d->numFrames; n++) {
+            auto strided{ n % d->subsample == 0 && (d->subsample > 1 || d->cascade <= 0.0) };
+            d->sampled[n] = strided ? sampleScored : d->subsampleIframes || d->cascade > 0.0 ? sampleUndecided : sampleSkipped;
+            d->screen[n] = std::numeric_limits<double>::quiet_NaN();
+        }
+
+        for (auto&& shard : d->renditions.front()->shards) {
+            d->sampled[shard->first] = sampleScored;
+            d->sampled[shard->last] = sampleScored;
+        }
+
+        // With a model the frame before each scored one is read as its anchor.
+        for (unsigned n{ 1 }; !d->model.empty() && n < d->numFrames; n++)
+            if (d->sampled[n] == sampleScored && d->sampled[n - 1] == sampleSkipped)
+                d->sampled[n - 1] = sampleAnchor;
+
+        // Runs of repeated frames are scored once.
+        d->reuseRepeats = !d->native && !d->sampling && !d->props && d->subsample == 1 && d->cascade <= 0.0 && !d->cache;
+
+        if (d->reuseRepeats || d->cache) {
+            d->referenceHash = std::make_unique<std::atomic<uint64_t>[]>(d->numFrames);
+
+            for (auto&& rendition : d->renditions) {
+                rendition->distortedHash = std::make_unique<std::atomic<uint64_t>[]>(d->numFrames);
+
+                if (d->reuseRepeats)
+                    rendition->repeated = std::make_unique<std::atomic<bool>[]>(d->numFrames);
+
+                if (d->cache) {
+                    rendition->frameKey = std::make_unique<std::atomic<uint64_t>[]>(d->numFrames);
+                    rendition->cached = std::make_unique<std::atomic<uint8_t>[]>(d->numFrames);
+                }
+            }
+        }
+
+        for (auto&& rendition : d->renditions) {
+            rendition->writer = std::make_unique<LogWriter>(rendition->logPath, d->logFormat, d->pictureWidth, d->pictureHeight,
+                                                            d->numFrames);
+
+            if (!rendition->writer->open(d->sampling ? 1 : std::max<size_t>(rendition->shards.size(), 1)))
+                throw "failed to open log file: "s + rendition->logPath;
+
+            rendition->writer->setCrop(d->cropLeft, d->cropRight, d->cropTop, d->cropBottom, d->cropDetected);
+            rendition->writer->setFirstFrame(d->first);
+
+            if (d->preview)
+                rendition->writer->setPreview();
+
+            if (d->sectioned)
+                rendition->writer->trackSections();
+
+            if (d->subsample > 1 || d->cascade > 0.0)
+                rendition->writer->trackInterpolation();
+
+            if (d->native) {
+                std::vector<std::string> aliases;
+                for (auto&& score : d->scores)
+                    aliases.push_back(score.name);
+
+                rendition->written.assign(aliases.size(), true);
+                rendition->writer->setColumns(std::move(aliases));
+                rendition->cursors.push_back({ 0, 0, 0, 0, {}, {} });
+            }
+
+            if (!d->native) {
+                rendition->score.resize(rendition->names.size());
+                rendition->written.resize(rendition->names.size());
+                rendition->writer->setColumns(columnAliases);
+
+                if (d->cache)
+                    d->cache->addColumns(rendition->cacheConfig, rendition->names, columnAliases);
+            }
+        }
+
+        // Output frame n draws the n-th frame of the order, with the last frame of the range moved to the end.
+        if (d->sampling) {
+            if (d->scores.empty())
+                throw "sample_margin requires a model or feature to estimate"s;
+
+            StratifiedSample strata{ d->numFrames, std::min(d->sampleStrata, d->numFrames) };
+            d->sampleOrder = strata.order(0);
+            std::stable_partition(d->sampleOrder.begin(), d->sampleOrder.end(),
+                                  [&](unsigned k) { return k != d->numFrames - 1; });
+            d->slot = std::make_unique<std::atomic<uint8_t>[]>(d->numFrames);
+
+            for (auto&& rendition : d->renditions) {
+                rendition->sample = std::make_unique<StratifiedSample>(strata);
+                rendition->estimate = { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), 0 };
+            }
+        }
+
+        // The submission threads start once every log is open, so that a log that fails to open leaves none running.
+        for (auto&& rendition : d->renditions) {
+            for (unsigned i{ 0 }; i < rendition->shards.size(); i++) {
+                auto&& shard{ rendition->shards[i] };
+                shard->sequencer.perfect = &d->perfectScores;
+
+                if (d->sampling) {
+                    auto numShards{ static_cast<unsigned>(rendition->shards.size()) };
+                    auto slots{ (d->numFrames - i + numShards - 1) / numShards };
+
+                    rendition->cursors.push_back({ 0, 0, 0, 0, {}, {} });
+                    shard->sequencer.start(shard->vmaf, queueDepth, reorderWindow, 0, slots * 3 - 1);
+                    continue;
+                }
+
+                rendition->cursors.push_back({ shard->first, shard->first, shard->first, shard->first, {}, {} });
+                shard->sequencer.start(shard->vmaf, queueDepth, reorderWindow, shard->feedFirst, shard->feedLast);
+            }
+        }
+
+        d->collector.worker = std::thread{ runCollector, d.get() };
     } catch (const std::string& error) {
         vsapi->mapSetError(out, (d->filterName + ": " + error).c_str());
 
         vsapi->freeNode(d->reference);
-        vsapi->freeNode(d->distorted);
+        for (auto&& rendition : d->renditions)
+            vsapi->freeNode(rendition->distorted);
 
-        for (auto&& m : d->model)
-            vmaf_model_destroy(m);
-        for (auto&& m : d->modelCollection)
-            vmaf_model_collection_destroy(m);
-        vmaf_close(d->vmaf);
+        for (auto&& rendition : d->renditions)
+            for (auto&& shard : rendition->shards)
+                shard->sequencer.close();
+
+        destroyContexts(d.get());
 
         return;
     }
 
-    VSFilterDependency deps[]{ {d->reference, rpStrictSpatial}, {d->distorted, rpStrictSpatial} };
+    // Shards, lookahead, the scene detector, the cascade and sampling all request frames out of order.
+    auto&& shards{ d->renditions.front()->shards };
+    auto outOfOrder{ shards.size() > 1 || d->propLag || d->sceneDetect == 2 || d->cascade > 0.0 || d->sampling };
+    auto requestPattern{ outOfOrder ? rpGeneral : rpStrictSpatial };
+    auto mode{ d->native ? fmParallel : shards.front()->sequencer.depth ? fmParallelRequests : fmFrameState };
+
+    std::vector<VSFilterDependency> deps{ {d->reference, requestPattern} };
+    for (auto&& rendition : d->renditions)
+        deps.push_back({ rendition->distorted, requestPattern });
 
-    vsapi->createVideoFilter(out, d->filterName.c_str(), d->vi, vmafGetFrame, vmafFree, fmFrameState, deps, 2, d.get(), core);
+    vsapi->createVideoFilter(out, d->filterName.c_str(), d->vi, vmafGetFrame, vmafFree, mode, deps.data(),
+                             static_cast<int>(deps.size()), d.get(), core);
     d.release();
 }
 
@@ -309,11 +2804,38 @@ VS_EXTERNAL_API(void) VapourSynthPluginInit2(VSPlugin* plugin, const VSPLUGINAPI
 
     vspapi->registerFunction("VMAF",
                              "reference:vnode;"
-                             "distorted:vnode;"
-                             "log_path:data;"
+                             "distorted:vnode[];"
+                             "log_path:data[];"
                              "log_format:int:opt;"
                              "model:int[]:opt;"
-                             "feature:int[]:opt;",
+                             "feature:int[]:opt;"
+                             "zero_copy:int:opt;"
+                             "queue_depth:int:opt;"
+                             "shards:int:opt;"
+                             "props:int:opt;"
+                             "prop_lag:int:opt;"
+                             "prop_timeout:float:opt;"
+                             "scaler:int:opt;"
+                             "crop_left:int:opt;"
+                             "crop_right:int:opt;"
+                             "crop_top:int:opt;"
+                             "crop_bottom:int:opt;"
+                             "autocrop:int:opt;"
+                             "first:int:opt;"
+                             "last:int:opt;"
+                             "segments:int[]:opt;"
+                             "scene_detect:int:opt;"
+                             "scene_threshold:float:opt;"
+                             "subsample:int:opt;"
+                             "subsample_iframes:int:opt;"
+                             "preview:int:opt;"
+                             "ssim_map:int:opt;"
+                             "cascade:float:opt;"
+                             "sample_margin:float:opt;"
+                             "sample_confidence:float:opt;"
+                             "sample_strata:int:opt;"
+                             "cache_path:data:opt;"
+                             "native:int:opt;",
                              "clip:vnode;",
                              vmafCreate, const_cast<char*>("VMAF"), plugin);
 
@@ -0,0 +1,37 @@
+/*
+    MIT License
+
+    Copyright (c) 2018-2022 HolyWu
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#pragma once
+
+// libvmaf symbols outside its public headers, which only a static libvmaf exports. They are what vmaf_picture_alloc itself uses
+// to attach a release callback and reference count to a picture, and let us hand libvmaf memory it does not own. meson checks
+// that they link before defining VMAF_PRIVATE_API.
+extern "C" {
+#include <libvmaf.h>
+
+int vmaf_picture_priv_init(VmafPicture* pic);
+int vmaf_picture_set_release_callback(VmafPicture* pic, void* cookie, int (*release_picture)(VmafPicture* pic, void* cookie));
+int vmaf_picture_ref(VmafPicture* dst, VmafPicture* src);
+int vmaf_ref_init(VmafRef** ref);
+}